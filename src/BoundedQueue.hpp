@@ -0,0 +1,86 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+// Fixed-capacity lock-free queue for any number of producers and consumers (Dmitry Vyukov's bounded MPMC queue).
+// Every cell carries a sequence number telling whether it is ready to be written or read at a given position, so a
+// push or pop is one compare-and-swap on the shared position plus a release store on the cell.
+template <typename T>
+class BoundedQueue {
+    struct Cell {
+        std::atomic<size_t> sequence;
+        T value;
+    };
+
+    std::unique_ptr<Cell[]> m_cells;
+    size_t m_mask;
+
+    alignas(64) std::atomic<size_t> m_pushPosition{ 0 };
+    alignas(64) std::atomic<size_t> m_popPosition{ 0 };
+
+public:
+    // capacity is rounded up to a power of two
+    explicit BoundedQueue(size_t capacity) {
+        size_t size{ 2 };
+        while (size < capacity) size *= 2;
+
+        m_cells = std::make_unique<Cell[]>(size);
+        m_mask = size - 1;
+
+        for (size_t i = 0; i < size; i++) {
+            m_cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    // false if the queue is full
+    bool tryPush(T&& value) {
+        size_t position{ m_pushPosition.load(std::memory_order_relaxed) };
+
+        while (true) {
+            Cell& cell{ m_cells[position & m_mask] };
+            const std::intptr_t difference{ static_cast<std::intptr_t>(cell.sequence.load(std::memory_order_acquire)) - static_cast<std::intptr_t>(position) };
+
+            if (difference == 0) {
+                if (m_pushPosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    cell.value = std::move(value);
+                    cell.sequence.store(position + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (difference < 0) {
+                return false;
+            }
+            else {
+                position = m_pushPosition.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // false if the queue is empty
+    bool tryPop(T& value) {
+        size_t position{ m_popPosition.load(std::memory_order_relaxed) };
+
+        while (true) {
+            Cell& cell{ m_cells[position & m_mask] };
+            const std::intptr_t difference{ static_cast<std::intptr_t>(cell.sequence.load(std::memory_order_acquire)) - static_cast<std::intptr_t>(position + 1) };
+
+            if (difference == 0) {
+                if (m_popPosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    value = std::move(cell.value);
+                    cell.sequence.store(position + m_mask + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (difference < 0) {
+                return false;
+            }
+            else {
+                position = m_popPosition.load(std::memory_order_relaxed);
+            }
+        }
+    }
+};
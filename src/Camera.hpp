@@ -7,6 +7,7 @@
 
 #include "RenderCube.hpp"
 #include "Cube.hpp"
+#include "Trace.hpp"
 
 class Camera {
     int m_imageWidth{};
@@ -42,7 +43,8 @@ class Camera {
         return std::abs(area) * 0.5f;
     }
 
-    void drawCube(sf::RenderWindow& win, const RenderCube& cube) const {
+    template <int N, typename Target>
+    void drawCube(Target& target, const BasicRenderCube<N>& cube) const {
         std::array<int, 6> faceOrder{ 0, 1, 2, 3, 4, 5 };
         std::sort(faceOrder.begin(), faceOrder.end(), [&cube](int a, int b) {
             return cube.getFaceNormal(a).dot({ 0.f, 0.f, -1.f }) > cube.getFaceNormal(b).dot({ 0.f, 0.f, -1.f });
@@ -51,16 +53,16 @@ class Camera {
         for (const int& i : faceOrder) {
             if (cube.getFaceNormal(i).dot({ 0.f, 0.f, -1.f }) > 0.f) continue;
 
-            const auto& vertexData{ Cube::faceVertexData[i] };
+            const auto& vertexData{ BasicRenderCube<N>::faceVertexData[i] };
             const auto& vertices{ cube.getVertices() };
 
             sf::Vector3f v0{ vertices[vertexData[0]] };
 
-            sf::Vector3f x{ (vertices[vertexData[1]] - v0) / static_cast<float>(numSides) };
-            sf::Vector3f y{ (vertices[vertexData[3]] - v0) / static_cast<float>(numSides) };
+            sf::Vector3f x{ (vertices[vertexData[1]] - v0) / static_cast<float>(N) };
+            sf::Vector3f y{ (vertices[vertexData[3]] - v0) / static_cast<float>(N) };
 
-            for (int j = 0; j < numSides; j++) {
-                for (int k = 0; k < numSides; k++) {
+            for (int j = 0; j < N; j++) {
+                for (int k = 0; k < N; k++) {
                     sf::Color faceColor{ cube.faceColors[i][j][k] };
                     if (faceColor == sf::Color::Black) continue;
 
@@ -80,7 +82,7 @@ class Camera {
                         face.setOutlineThickness(-1.5f);
                     }
 
-                    win.draw(face);
+                    target.draw(face);
                 }
             }
         }
@@ -95,18 +97,22 @@ public:
         m_viewPortCenter.z = viewportZ;
     }
 
-    void draw(sf::RenderWindow& win, const Cube& cube) const {
-        if (cube.getState() == Cube::IDLE) {
-            drawCube(win, cube);
+    // target is anything that can draw an sf::ConvexShape: a window, a render texture or a SoftwareRenderer
+    template <int N, typename Target>
+    void draw(Target& target, const BasicCube<N>& cube) const {
+        TRACE_SCOPE("Camera::draw");
+
+        if (cube.getState() == BasicCube<N>::IDLE) {
+            drawCube(target, cube);
         }
-        else if (cube.getState() == Cube::ROTATING) {
+        else if (cube.getState() == BasicCube<N>::ROTATING) {
             if (cube.getRotationAxis().dot({ 0.f, 0.f, -1.f }) > 0.f) {
-                drawCube(win, cube.getRenderCubes()[0]);
-                drawCube(win, cube.getRenderCubes()[1]);
+                drawCube(target, cube.getRenderCubes()[0]);
+                drawCube(target, cube.getRenderCubes()[1]);
             }
             else {
-                drawCube(win, cube.getRenderCubes()[1]);
-                drawCube(win, cube.getRenderCubes()[0]);
+                drawCube(target, cube.getRenderCubes()[1]);
+                drawCube(target, cube.getRenderCubes()[0]);
             }
         }
     }
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <algorithm>
 #include <array>
 #include <vector>
 #include <cassert>
@@ -7,137 +8,187 @@
 #include <iostream>
 
 #include "RenderCube.hpp"
+#include "RingBuffer.hpp"
+#include "Trace.hpp"
 
 #include <SFML/Graphics.hpp>
 
 
 // forward declarations
-class Cube;
+template <int N>
+class BasicCube;
+using Cube = BasicCube<3>;
 namespace Solver {
     void moveCube(Cube& cube, char move);
 };
 
 
-class Cube : public RenderCube {
+struct LayerTurn {
+    char face;
+    int layer{ 0 }; // 0 is the outer face, N - 1 the opposite face
+};
+
+
+template <int N>
+class BasicCube : public BasicRenderCube<N> {
+    using Base = BasicRenderCube<N>;
+    using Base::m_cubeletSize;
+    using Base::m_i;
+    using Base::m_j;
+    using Base::m_k;
+    using Base::getFaceNormal;
+
 public:
+    using Base::faceColors;
+
     enum State {
         IDLE,
         ROTATING,
     };
 
+    // turbo playback: past turboQueueLength queued turns the animation speeds up in proportion to the queue,
+    // past instantQueueLength the backlog is applied straight to the stickers so only the last turns animate
+    static constexpr size_t turboQueueLength{ 8 };
+    static constexpr size_t instantQueueLength{ 64 };
+    static constexpr int maxInstantTurnsPerUpdate{ 100000 }; // keeps a single frame short for huge queues
+
 private:
     State m_state{ IDLE };
     float m_rotationAngle{ 0.f };
-    std::vector<char> m_rotationQueue{};
-    std::array<RenderCube, 2> m_renderCubes{};
+    RingBuffer<LayerTurn> m_rotationQueue{};
+    bool m_turbo{ false };
+    std::array<Base, 2> m_renderCubes{};
     sf::Vector3f m_rotationAxis{};
 
     void rotateFace(int face) {
-        for (int i = 0; i < numSides; i++) {
+        for (int i = 0; i < N; i++) {
             for (int j = 0; j < i; j++) {
                 std::swap(faceColors[face][i][j], faceColors[face][j][i]);
             }
         }
 
-        for (int i = 0; i < numSides; i++) {
+        for (int i = 0; i < N; i++) {
             std::reverse(faceColors[face][i].begin(), faceColors[face][i].end());
         }
     }
 
+    void rotateFaceCounterClockwise(int face) {
+        for (int i = 0; i < N; i++) {
+            for (int j = 0; j < i; j++) {
+                std::swap(faceColors[face][i][j], faceColors[face][j][i]);
+            }
+        }
+
+        std::reverse(faceColors[face].begin(), faceColors[face].end());
+    }
+
+    // a layer turn moves the strip at depth Layer and, for the two outer layers, spins the face it touches
+    template <int Layer = 0>
     void U(bool clockwise = true) {
         for (int t = 0; t < (clockwise ? 1 : 3); t++) {
-            rotateFace(4);
+            if constexpr (Layer == 0) rotateFace(4);
+            if constexpr (Layer == N - 1) rotateFaceCounterClockwise(5);
 
-            for (int i = 0; i < numSides; i++) {
-                sf::Color last{ faceColors[1][0][i] };
+            for (int i = 0; i < N; i++) {
+                sf::Color last{ faceColors[1][Layer][i] };
 
                 for (int j : { 0, 3, 2, 1 }) {
-                    std::swap(last, faceColors[j][0][i]);
+                    std::swap(last, faceColors[j][Layer][i]);
                 }
 
             }
         }
     }
 
+    template <int Layer = 0>
     void D(bool clockwise = true) {
         for (int t = 0; t < (clockwise ? 1 : 3); t++) {
-            rotateFace(5);
+            if constexpr (Layer == 0) rotateFace(5);
+            if constexpr (Layer == N - 1) rotateFaceCounterClockwise(4);
 
-            for (int i = 0; i < numSides; i++) {
-                sf::Color last{ faceColors[3][numSides - 1][i] };
+            for (int i = 0; i < N; i++) {
+                sf::Color last{ faceColors[3][N - 1 - Layer][i] };
 
                 for (int j : { 0, 1, 2, 3 }) {
-                    std::swap(last, faceColors[j][numSides - 1][i]);
+                    std::swap(last, faceColors[j][N - 1 - Layer][i]);
                 }
             }
         }
     }
 
+    template <int Layer = 0>
     void L(bool clockwise = true) {
         for (int t = 0; t < (clockwise ? 1 : 3); t++) {
-            rotateFace(3);
+            if constexpr (Layer == 0) rotateFace(3);
+            if constexpr (Layer == N - 1) rotateFaceCounterClockwise(1);
 
-            for (int i = 0; i < numSides; i++) {
-                sf::Color last{ faceColors[2][numSides - i - 1][numSides - 1] };
+            for (int i = 0; i < N; i++) {
+                sf::Color last{ faceColors[2][N - i - 1][N - 1 - Layer] };
 
                 for (int j : { 4, 0, 5 }) {
-                    std::swap(last, faceColors[j][i][0]);
+                    std::swap(last, faceColors[j][i][Layer]);
                 }
-                std::swap(last, faceColors[2][numSides - i - 1][numSides - 1]);
+                std::swap(last, faceColors[2][N - i - 1][N - 1 - Layer]);
             }
         }
     }
 
+    template <int Layer = 0>
     void R(bool clockwise = true) {
         for (int t = 0; t < (clockwise ? 1 : 3); t++) {
-            rotateFace(1);
+            if constexpr (Layer == 0) rotateFace(1);
+            if constexpr (Layer == N - 1) rotateFaceCounterClockwise(3);
 
-            for (int i = 0; i < numSides; i++) {
-                sf::Color last{ faceColors[2][numSides - i - 1][0] };
+            for (int i = 0; i < N; i++) {
+                sf::Color last{ faceColors[2][N - i - 1][Layer] };
 
                 for (int j : { 5, 0, 4 }) {
-                    std::swap(last, faceColors[j][i][numSides - 1]);
+                    std::swap(last, faceColors[j][i][N - 1 - Layer]);
                 }
-                std::swap(last, faceColors[2][numSides - i - 1][0]);
+                std::swap(last, faceColors[2][N - i - 1][Layer]);
             }
         }
     }
 
+    template <int Layer = 0>
     void F(bool clockwise = true) {
         for (int t = 0; t < (clockwise ? 1 : 3); t++) {
-            rotateFace(0);
+            if constexpr (Layer == 0) rotateFace(0);
+            if constexpr (Layer == N - 1) rotateFaceCounterClockwise(2);
 
-            for (int i = 0; i < numSides; i++) {
-                sf::Color last{ faceColors[4][numSides - 1][i] };
+            for (int i = 0; i < N; i++) {
+                sf::Color last{ faceColors[4][N - 1 - Layer][i] };
 
-                std::swap(last, faceColors[1][i][0]);
-                std::swap(last, faceColors[5][0][numSides - 1 - i]);
-                std::swap(last, faceColors[3][numSides - 1 - i][numSides - 1]);
-                std::swap(last, faceColors[4][numSides - 1][i]);
+                std::swap(last, faceColors[1][i][Layer]);
+                std::swap(last, faceColors[5][Layer][N - 1 - i]);
+                std::swap(last, faceColors[3][N - 1 - i][N - 1 - Layer]);
+                std::swap(last, faceColors[4][N - 1 - Layer][i]);
             }
         }
     }
 
+    template <int Layer = 0>
     void B(bool clockwise = true) {
         for (int t = 0; t < (clockwise ? 1 : 3); t++) {
-            rotateFace(2);
+            if constexpr (Layer == 0) rotateFace(2);
+            if constexpr (Layer == N - 1) rotateFaceCounterClockwise(0);
 
-            for (int i = 0; i < numSides; i++) {
-                sf::Color last{ faceColors[4][0][i] };
+            for (int i = 0; i < N; i++) {
+                sf::Color last{ faceColors[4][Layer][i] };
 
-                std::swap(last, faceColors[3][numSides - 1 - i][0]);
-                std::swap(last, faceColors[5][numSides - 1][numSides - 1 - i]);
-                std::swap(last, faceColors[1][i][numSides - 1]);
-                std::swap(last, faceColors[4][0][i]);
+                std::swap(last, faceColors[3][N - 1 - i][Layer]);
+                std::swap(last, faceColors[5][N - 1 - Layer][N - 1 - i]);
+                std::swap(last, faceColors[1][i][N - 1 - Layer]);
+                std::swap(last, faceColors[4][Layer][i]);
             }
         }
     }
 
-    void newRotation(char rotationType) {
+    void newRotation(const LayerTurn& turn) {
         m_state = ROTATING;
 
-        m_renderCubes[0] = RenderCube{ m_cubeletSize, m_i, m_j, m_k };
-        m_renderCubes[1] = RenderCube{ m_cubeletSize, m_i, m_j, m_k };
+        m_renderCubes[0] = Base{ m_cubeletSize, m_i, m_j, m_k };
+        m_renderCubes[1] = Base{ m_cubeletSize, m_i, m_j, m_k };
 
         m_renderCubes[0].faceColors = faceColors;
         m_renderCubes[1].setFaceColorEmpty();
@@ -145,68 +196,77 @@ private:
         auto& a{ m_renderCubes[0].faceColors };
         auto& b{ m_renderCubes[1].faceColors };
 
+        const int d{ turn.layer };
+        const char rotationType{ turn.face };
+
         if (rotationType == 'U') {
             m_rotationAxis = -getFaceNormal(4);
-            std::swap(a[4], b[4]);
+            if (d == 0) std::swap(a[4], b[4]);
+            if (d == N - 1) std::swap(a[5], b[5]);
 
-            for (int i = 0; i < numSides; i++) {
+            for (int i = 0; i < N; i++) {
                 for (int j = 0; j <= 3; j++) {
-                    std::swap(a[j][0][i], b[j][0][i]);
+                    std::swap(a[j][d][i], b[j][d][i]);
                 }
             }
         }
         else if (rotationType == 'D') {
             m_rotationAxis = -getFaceNormal(5);
-            std::swap(a[5], b[5]);
+            if (d == 0) std::swap(a[5], b[5]);
+            if (d == N - 1) std::swap(a[4], b[4]);
 
-            for (int i = 0; i < numSides; i++) {
+            for (int i = 0; i < N; i++) {
                 for (int j = 0; j <= 3; j++) {
-                    std::swap(a[j][numSides - 1][i], b[j][numSides - 1][i]);
+                    std::swap(a[j][N - 1 - d][i], b[j][N - 1 - d][i]);
                 }
             }
         }
         else if (rotationType == 'L') {
             m_rotationAxis = -getFaceNormal(3);
-            std::swap(a[3], b[3]);
+            if (d == 0) std::swap(a[3], b[3]);
+            if (d == N - 1) std::swap(a[1], b[1]);
 
-            for (int i = 0; i < numSides; i++) {
+            for (int i = 0; i < N; i++) {
                 for (int j : {0, 4, 5}) {
-                    std::swap(a[j][i][0], b[j][i][0]);
+                    std::swap(a[j][i][d], b[j][i][d]);
                 }
-                std::swap(a[2][i][numSides - 1], b[2][i][numSides - 1]);
+                std::swap(a[2][i][N - 1 - d], b[2][i][N - 1 - d]);
             }
         }
         else if (rotationType == 'R') {
             m_rotationAxis = -getFaceNormal(1);
-            std::swap(a[1], b[1]);
+            if (d == 0) std::swap(a[1], b[1]);
+            if (d == N - 1) std::swap(a[3], b[3]);
 
-            for (int i = 0; i < numSides; i++) {
+            for (int i = 0; i < N; i++) {
                 for (int j : {0, 4, 5}) {
-                    std::swap(a[j][i][numSides - 1], b[j][i][numSides - 1]);
+                    std::swap(a[j][i][N - 1 - d], b[j][i][N - 1 - d]);
                 }
-                std::swap(a[2][i][0], b[2][i][0]);
+                std::swap(a[2][i][d], b[2][i][d]);
             }
         }
         else if (rotationType == 'F') {
             m_rotationAxis = -getFaceNormal(0);
-            std::swap(a[0], b[0]);
-
-            for (int i = 0; i < numSides; i++) {
-                std::swap(a[4][numSides - 1][i], b[4][numSides - 1][i]);
-                std::swap(a[1][i][0], b[1][i][0]);
-                std::swap(a[5][0][i], b[5][0][i]);
-                std::swap(a[3][i][numSides - 1], b[3][i][numSides - 1]);
+            if (d == 0) std::swap(a[0], b[0]);
+            if (d == N - 1) std::swap(a[2], b[2]);
+
+            for (int i = 0; i < N; i++) {
+                std::swap(a[4][N - 1 - d][i], b[4][N - 1 - d][i]);
+                std::swap(a[1][i][d], b[1][i][d]);
+                std::swap(a[5][d][i], b[5][d][i]);
+                std::swap(a[3][i][N - 1 - d], b[3][i][N - 1 - d]);
             }
         }
         else if (rotationType == 'B') {
             m_rotationAxis = -getFaceNormal(2);
-            std::swap(a[2], b[2]);
-
-            for (int i = 0; i < numSides; i++) {
-                std::swap(a[4][0][i], b[4][0][i]);
-                std::swap(a[1][i][numSides - 1], b[1][i][numSides - 1]);
-                std::swap(a[5][numSides - 1][i], b[5][numSides - 1][i]);
-                std::swap(a[3][i][0], b[3][i][0]);
+            if (d == 0) std::swap(a[2], b[2]);
+            if (d == N - 1) std::swap(a[0], b[0]);
+
+            for (int i = 0; i < N; i++) {
+                std::swap(a[4][d][i], b[4][d][i]);
+                std::swap(a[1][i][N - 1 - d], b[1][i][N - 1 - d]);
+                std::swap(a[5][N - 1 - d][i], b[5][N - 1 - d][i]);
+                std::swap(a[3][i][d], b[3][i][d]);
             }
 
         }
@@ -214,17 +274,37 @@ private:
 
 
 public:
-    Cube(float cubeletSize) : RenderCube{ cubeletSize } {}
+    BasicCube(float cubeletSize) : Base{ cubeletSize } {}
 
     friend void Solver::moveCube(Cube& cube, char move);
 
+    // applies a quarter turn of the given layer immediately, without animating it
+    void turn(char face, int layer = 0, bool clockwise = true) {
+        unroll<N>([&](auto l) {
+            constexpr int Layer{ decltype(l)::value };
+            if (Layer != layer) return;
+
+            switch (face) {
+            case 'U': U<Layer>(clockwise); break;
+            case 'D': D<Layer>(clockwise); break;
+            case 'L': L<Layer>(clockwise); break;
+            case 'R': R<Layer>(clockwise); break;
+            case 'F': F<Layer>(clockwise); break;
+            case 'B': B<Layer>(clockwise); break;
+            default:
+                std::cerr << "Invalid rotation type: " << face << std::endl;
+                break;
+            }
+            });
+    }
+
     void shuffle(int numberOfRotations) {
         for (int i = 0; i < numberOfRotations; i++) {
-            startRotation("UDFBLR"[rand() % 6]);
+            startRotation("UDFBLR"[rand() % 6], rand() % (N / 2)); // outer blocks only, so a 3x3 keeps its centers
         }
     }
 
-    const std::array<RenderCube, 2>& getRenderCubes() const {
+    const std::array<Base, 2>& getRenderCubes() const {
         return m_renderCubes;
     }
 
@@ -232,15 +312,45 @@ public:
         return m_state;
     }
 
-    void startRotation(char type) {
-        m_rotationQueue.push_back(type);
+    void startRotation(char type, int layer = 0) {
+        assert(layer >= 0 && layer < N && "Invalid layer index");
+        m_rotationQueue.push_back({ type, layer });
 
         if (m_state == IDLE) {
-            newRotation(type);
+            newRotation(m_rotationQueue.front());
         }
     }
 
+    void setTurbo(bool enabled) {
+        m_turbo = enabled;
+    }
+
+    bool isTurbo() const {
+        return m_turbo;
+    }
+
+    // turns still queued, including the one being animated
+    size_t getQueueLength() const {
+        return m_rotationQueue.size();
+    }
+
     void manageRotation(float rotationSpeed) {
+        TRACE_SCOPE("Cube::manageRotation");
+
+        if (m_state == ROTATING && m_turbo && m_rotationQueue.size() > instantQueueLength) {
+            for (int i = 0; i < maxInstantTurnsPerUpdate && m_rotationQueue.size() > instantQueueLength; i++) {
+                turn(m_rotationQueue.front().face, m_rotationQueue.front().layer);
+                m_rotationQueue.pop_front();
+            }
+
+            m_rotationAngle = 0.f;
+            newRotation(m_rotationQueue.front());
+        }
+
+        if (m_state == ROTATING && m_turbo) {
+            rotationSpeed *= std::max(1.f, static_cast<float>(m_rotationQueue.size()) / turboQueueLength);
+        }
+
         if (m_state == ROTATING) {
             m_rotationAngle += rotationSpeed;
             m_renderCubes[1].rotate(rotationSpeed * (M_PI / 180.f), m_rotationAxis);
@@ -248,19 +358,9 @@ public:
             if (m_rotationAngle >= 90.f) {
                 m_rotationAngle = 0.f;
 
-                switch (m_rotationQueue.front()) {
-                case 'U': U(); break;
-                case 'D': D(); break;
-                case 'L': L(); break;
-                case 'R': R(); break;
-                case 'F': F(); break;
-                case 'B': B(); break;
-                default:
-                    std::cerr << "Invalid rotation type: " << m_rotationQueue.front() << std::endl;
-                    break;
-                }
+                turn(m_rotationQueue.front().face, m_rotationQueue.front().layer);
 
-                m_rotationQueue.erase(m_rotationQueue.begin());
+                m_rotationQueue.pop_front();
 
                 if (m_rotationQueue.empty()) {
                     m_state = IDLE;
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+// Every phase 2 state within a few moves of solved, with its exact distance and a move that takes it one closer,
+// so a phase 2 search reaching one of them can finish with lookups instead of searching the last plies. States
+// not in the table are further than its depth. Read-only once built: an open addressing hash table with linear
+// probing over 64 bit entries holding key, distance and move, at most half full. The slots are owned by m_storage,
+// a vector of its own or a shared memory segment.
+class EndgameTable {
+    std::shared_ptr<const void> m_storage{};
+    const std::uint64_t* m_entries{ nullptr }; // 0 for an empty slot
+    size_t m_mask{ 0 };
+    int m_depth{ -1 };
+
+    static constexpr int keyShift{ 8 }; // keys must stay below 2^55, key + 1 is stored so no entry is 0
+
+    size_t index(std::uint64_t key) const {
+        return static_cast<size_t>((key * 0x9e3779b97f4a7c15ULL) >> 20) & m_mask;
+    }
+
+public:
+    struct Hit {
+        int distance; // -1 if the state is further than the depth
+        int move;
+    };
+
+    // an entry as generated and stored on disk: distance and move each below 16
+    static constexpr std::uint64_t pack(std::uint64_t key, int distance, int move) {
+        return ((key + 1) << keyShift) | static_cast<std::uint64_t>(distance) << 4 | static_cast<std::uint64_t>(move);
+    }
+
+    EndgameTable() = default;
+
+    // from entries made by pack, each key once
+    explicit EndgameTable(const std::vector<std::uint64_t>& entries) {
+        auto slots{ std::make_shared<std::vector<std::uint64_t>>(slotsFor(entries.size()), 0) };
+        m_mask = slots->size() - 1;
+
+        for (std::uint64_t entry : entries) {
+            size_t slot{ index((entry >> keyShift) - 1) };
+            while ((*slots)[slot] != 0) slot = (slot + 1) & m_mask;
+
+            (*slots)[slot] = entry;
+            m_depth = std::max(m_depth, static_cast<int>((entry >> 4) & 0xf));
+        }
+
+        m_entries = slots->data();
+        m_storage = std::move(slots);
+    }
+
+    // the slots of a table built before, e.g. copied into shared memory; size is a power of two
+    EndgameTable(std::shared_ptr<const void> storage, const std::uint64_t* slots, size_t size, int depth) :
+        m_storage(std::move(storage)), m_entries(slots), m_mask(size - 1), m_depth(depth) {}
+
+    // slots of the table built from that many entries
+    static size_t slotsFor(size_t entries) {
+        size_t size{ 1 };
+        while (size < entries * 2) size *= 2;
+
+        return size;
+    }
+
+    bool empty() const {
+        return m_depth < 0;
+    }
+
+    // every state this close is in the table
+    int getDepth() const {
+        return m_depth;
+    }
+
+    const std::uint64_t* data() const {
+        return m_entries;
+    }
+
+    // in slots
+    size_t size() const {
+        return m_entries ? m_mask + 1 : 0;
+    }
+
+    size_t getBytes() const {
+        return size() * sizeof(std::uint64_t);
+    }
+
+    Hit lookup(std::uint64_t key) const {
+        if (empty()) return { -1, 0 };
+
+        for (size_t slot = index(key); m_entries[slot] != 0; slot = (slot + 1) & m_mask) {
+            const std::uint64_t entry{ m_entries[slot] };
+            if ((entry >> keyShift) == key + 1) return { static_cast<int>((entry >> 4) & 0xf), static_cast<int>(entry & 0xf) };
+        }
+
+        return { -1, 0 };
+    }
+};
@@ -0,0 +1,194 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+
+#if defined(__SSSE3__) || defined(__AVX2__) || defined(__AVX512VBMI__)
+#include <immintrin.h>
+#endif
+
+#include <SFML/Graphics.hpp>
+
+#include "RenderCube.hpp"
+#include "Cube.hpp"
+
+// 3x3 state with one byte per sticker, laid out as face * 9 + row * 3 + col in the
+// FRBLUD face order of FaceColors. A byte holds the index of the sticker's colour in
+// defaultFaceColors, the 10 bytes past the last sticker are padding.
+// Moves are numbered like the phase 1 search: face * 3 + (quarter turns - 1), faces in FRBLUD order.
+struct alignas(64) FaceletCube {
+    static constexpr int numFacelets{ 54 };
+    static constexpr int numMoves{ 18 };
+    static constexpr std::uint8_t unknownColor{ 6 };
+
+    std::array<std::uint8_t, 64> facelets{};
+
+    FaceletCube() {
+        for (int i = 0; i < 64; i++) {
+            facelets[i] = i < numFacelets ? static_cast<std::uint8_t>(i / 9) : 0;
+        }
+    }
+
+    static FaceletCube fromFaceColors(const FaceColors& colors) {
+        FaceletCube cube{};
+
+        for (int i = 0; i < numFacelets; i++) {
+            const sf::Color color{ colors[i / 9][(i % 9) / 3][i % 3] };
+            cube.facelets[i] = unknownColor;
+
+            for (int c = 0; c < 6; c++) {
+                if (color == defaultFaceColors[c]) {
+                    cube.facelets[i] = static_cast<std::uint8_t>(c);
+                    break;
+                }
+            }
+        }
+
+        return cube;
+    }
+
+    // one letter per facelet naming the face whose colour it has, e.g. the solved cube is "FFFFFFFFFRRR..."
+    static FaceletCube fromString(std::string_view text) {
+        FaceletCube cube{};
+
+        for (int i = 0; i < numFacelets; i++) {
+            const size_t color{ i < static_cast<int>(text.size()) ? std::string_view{ "FRBLUD" }.find(text[i]) : std::string_view::npos };
+            cube.facelets[i] = color == std::string_view::npos ? unknownColor : static_cast<std::uint8_t>(color);
+        }
+
+        return cube;
+    }
+
+    std::string toString() const {
+        std::string text(numFacelets, '?');
+
+        for (int i = 0; i < numFacelets; i++) {
+            if (facelets[i] < 6) text[i] = "FRBLUD"[facelets[i]];
+        }
+
+        return text;
+    }
+
+    FaceColors toFaceColors() const {
+        FaceColors colors{};
+
+        for (int i = 0; i < numFacelets; i++) {
+            colors[i / 9][(i % 9) / 3][i % 3] = facelets[i] < 6 ? defaultFaceColors[facelets[i]] : sf::Color::Black;
+        }
+
+        return colors;
+    }
+
+    bool isSolved() const {
+        return *this == FaceletCube{};
+    }
+
+    bool operator==(const FaceletCube& other) const {
+        return std::memcmp(facelets.data(), other.facelets.data(), numFacelets) == 0;
+    }
+
+    bool operator!=(const FaceletCube& other) const {
+        return !(*this == other);
+    }
+
+    void move(int move) {
+        const MoveTables& tables{ moveTables() };
+
+#if defined(__AVX512VBMI__)
+        const __m512i state{ _mm512_load_si512(facelets.data()) };
+        const __m512i index{ _mm512_load_si512(tables.permutation[move].data()) };
+        _mm512_store_si512(facelets.data(), _mm512_permutexvar_epi8(index, state));
+#elif defined(__AVX2__)
+        // vpshufb only shuffles within 128 bit lanes, so every source lane is broadcast to both
+        // lanes and the four partial shuffles are merged (out of range mask bytes shuffle in zero)
+        const __m128i* in{ reinterpret_cast<const __m128i*>(facelets.data()) };
+        const __m256i* masks{ reinterpret_cast<const __m256i*>(tables.shuffleMasks[move].data()) };
+
+        __m256i low{ _mm256_setzero_si256() };
+        __m256i high{ _mm256_setzero_si256() };
+
+        for (int j = 0; j < 4; j++) {
+            const __m256i source{ _mm256_broadcastsi128_si256(_mm_load_si128(in + j)) };
+            low = _mm256_or_si256(low, _mm256_shuffle_epi8(source, _mm256_load_si256(masks + j * 2)));
+            high = _mm256_or_si256(high, _mm256_shuffle_epi8(source, _mm256_load_si256(masks + j * 2 + 1)));
+        }
+
+        _mm256_store_si256(reinterpret_cast<__m256i*>(facelets.data()), low);
+        _mm256_store_si256(reinterpret_cast<__m256i*>(facelets.data() + 32), high);
+#elif defined(__SSSE3__)
+        const __m128i* in{ reinterpret_cast<const __m128i*>(facelets.data()) };
+        const __m128i* masks{ reinterpret_cast<const __m128i*>(tables.shuffleMasks[move].data()) };
+        const __m128i source[4]{ _mm_load_si128(in), _mm_load_si128(in + 1), _mm_load_si128(in + 2), _mm_load_si128(in + 3) };
+
+        for (int k = 0; k < 4; k++) {
+            __m128i out{ _mm_setzero_si128() };
+
+            for (int j = 0; j < 4; j++) {
+                out = _mm_or_si128(out, _mm_shuffle_epi8(source[j], _mm_load_si128(masks + j * 4 + k)));
+            }
+
+            _mm_store_si128(reinterpret_cast<__m128i*>(facelets.data()) + k, out);
+        }
+#else
+        const auto& permutation{ tables.permutation[move] };
+        std::array<std::uint8_t, 64> out;
+
+        for (int i = 0; i < 64; i++) {
+            out[i] = facelets[permutation[i]];
+        }
+
+        facelets = out;
+#endif
+    }
+
+private:
+    struct MoveTables {
+        // facelet i after the move is facelet permutation[i] before it
+        alignas(64) std::array<std::array<std::uint8_t, 64>, numMoves> permutation{};
+
+        // per move, source lane j and destination lane k: the pshufb mask picking the bytes of
+        // lane k that come from lane j, stored at [j * 4 + k] so lanes 0-1 and 2-3 form one 256 bit mask
+        alignas(64) std::array<std::array<std::uint8_t, 256>, numMoves> shuffleMasks{};
+    };
+
+    // the permutations are read off the Cube move code by turning a cube whose stickers carry their own index
+    static const MoveTables& moveTables() {
+        static const MoveTables tables{ [] {
+            MoveTables result{};
+
+            for (int move = 0; move < numMoves; move++) {
+                Cube cube{ 0.f };
+
+                for (int i = 0; i < numFacelets; i++) {
+                    cube.faceColors[i / 9][(i % 9) / 3][i % 3] = sf::Color{ static_cast<std::uint8_t>(i), 0, 0 };
+                }
+
+                for (int t = 0; t < move % 3 + 1; t++) {
+                    cube.turn("FRBLUD"[move / 3]);
+                }
+
+                auto& permutation{ result.permutation[move] };
+
+                for (int i = 0; i < 64; i++) {
+                    permutation[i] = i < numFacelets ? cube.faceColors[i / 9][(i % 9) / 3][i % 3].r : static_cast<std::uint8_t>(i);
+                }
+
+                for (int j = 0; j < 4; j++) {
+                    for (int k = 0; k < 4; k++) {
+                        for (int b = 0; b < 16; b++) {
+                            const int source{ permutation[k * 16 + b] };
+                            result.shuffleMasks[move][(j * 4 + k) * 16 + b] = source / 16 == j ? static_cast<std::uint8_t>(source % 16) : 0x80;
+                        }
+                    }
+                }
+            }
+
+            return result;
+            }() };
+
+        return tables;
+    }
+};
@@ -0,0 +1,213 @@
+#pragma once
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <SFML/Graphics.hpp>
+
+#include "Camera.hpp"
+#include "Cube.hpp"
+#include "ShapeBatch.hpp"
+#include "Solver.hpp"
+
+// A grid of independent 3x3 cubes, each endlessly shuffled, solved by a background pool and animated on its own,
+// all drawn as one vertex array per frame. Shows solver throughput live in the window title.
+namespace GridViewer {
+    constexpr int windowWidth{ 1280 };
+    constexpr int windowHeight{ 960 };
+
+    constexpr int minCellSize{ 16 }; // pixels; smaller cells would not show a cube
+    constexpr int maxColumns{ windowWidth / minCellSize };
+    constexpr int maxRows{ windowHeight / minCellSize };
+
+    constexpr float rotationSpeed{ .1f };
+    constexpr float faceRotationSpeed{ 500.f };
+    constexpr float cubeletSize{ 2.f };
+    constexpr unsigned maxFramerate{ 60 };
+    constexpr int shuffleLength{ 20 };
+
+    // solves cubes on background threads; the render loop collects finished solutions once per frame
+    class SolverPool {
+        struct Request {
+            int cell;
+            Cube cube;
+        };
+
+        const Solver::Tables& m_tables;
+        std::vector<std::thread> m_workers{};
+        std::deque<Request> m_requests{};
+        std::vector<std::pair<int, std::vector<char>>> m_solutions{};
+        std::mutex m_mutex{};
+        std::condition_variable m_condition{};
+        bool m_stopping{ false };
+
+        void work() {
+            while (true) {
+                std::unique_lock lock{ m_mutex };
+                m_condition.wait(lock, [this] { return m_stopping || !m_requests.empty(); });
+                if (m_stopping) return;
+
+                Request request{ std::move(m_requests.front()) };
+                m_requests.pop_front();
+                lock.unlock();
+
+                const Solver::SolveResult result{ Solver::solveWithOptions(request.cube, {}, m_tables) };
+                std::vector<char> moves{ result.moves ? Solver::toQuarterTurns(*result.moves) : std::vector<char>{} };
+
+                lock.lock();
+                m_solutions.emplace_back(request.cell, std::move(moves));
+            }
+        }
+
+    public:
+        SolverPool(const Solver::Tables& tables, int threads) : m_tables(tables) {
+            for (int i = 0; i < threads; i++) {
+                m_workers.emplace_back([this] { work(); });
+            }
+        }
+
+        ~SolverPool() {
+            {
+                std::lock_guard lock{ m_mutex };
+                m_stopping = true;
+            }
+
+            m_condition.notify_all();
+            for (auto& worker : m_workers) worker.join();
+        }
+
+        void submit(int cell, const Cube& cube) {
+            {
+                std::lock_guard lock{ m_mutex };
+                m_requests.push_back({ cell, cube });
+            }
+
+            m_condition.notify_one();
+        }
+
+        // solutions finished since the last call, as (cell, quarter turns)
+        std::vector<std::pair<int, std::vector<char>>> takeSolutions() {
+            std::lock_guard lock{ m_mutex };
+            return std::exchange(m_solutions, {});
+        }
+    };
+
+    struct Cell {
+        enum Phase {
+            SHUFFLING,
+            SOLVING,
+            PLAYING
+        };
+
+        Cube cube{ cubeletSize };
+        Phase phase{ SHUFFLING };
+    };
+
+    // columns and rows from 1 to maxColumns and maxRows
+    void run(int columns, int rows) {
+        const int cellWidth{ windowWidth / columns };
+        const int cellHeight{ windowHeight / rows };
+        const Camera cam{ cellWidth, cellHeight };
+
+        sf::ContextSettings settings;
+        settings.antiAliasingLevel = 8;
+        auto window{ sf::RenderWindow(sf::VideoMode({ static_cast<unsigned>(cellWidth * columns), static_cast<unsigned>(cellHeight * rows) }), "SFML", sf::Style::Default, sf::State::Windowed, settings) };
+        window.setFramerateLimit(maxFramerate);
+
+        const Solver::Tables& tables{ Solver::getTables() };
+        SolverPool solvers{ tables, std::max(1, static_cast<int>(std::thread::hardware_concurrency()) - 1) }; // one core is left for drawing
+
+        std::vector<Cell> cells(columns * rows);
+        for (Cell& cell : cells) {
+            cell.cube.rotate(0.5f, { 1.f, 0.f, 0.f }); // look at the corner between U, F and R
+            cell.cube.rotate(-0.6f, { 0.f, 1.f, 0.f });
+            cell.cube.shuffle(shuffleLength);
+        }
+
+        ShapeBatch batch{};
+        sf::Clock clock;
+        sf::Clock statsClock;
+        long long solves{ 0 };
+        long long solvesAtLastTitle{ 0 };
+        int frames{ 0 };
+
+        while (window.isOpen())
+        {
+            while (const std::optional event{ window.pollEvent() })
+            {
+                if (event->is<sf::Event::Closed>())
+                    window.close();
+
+                else if (const auto* keyPressed = event->getIf<sf::Event::KeyPressed>())
+                {
+                    sf::Vector3f axis{};
+                    float angle{ 0.f };
+
+                    if (keyPressed->scancode == sf::Keyboard::Scancode::Up) { angle = -rotationSpeed; axis = { 1.f, 0.f, 0.f }; }
+                    else if (keyPressed->scancode == sf::Keyboard::Scancode::Down) { angle = rotationSpeed; axis = { 1.f, 0.f, 0.f }; }
+                    else if (keyPressed->scancode == sf::Keyboard::Scancode::Left) { angle = -rotationSpeed; axis = { 0.f, 1.f, 0.f }; }
+                    else if (keyPressed->scancode == sf::Keyboard::Scancode::Right) { angle = rotationSpeed; axis = { 0.f, 1.f, 0.f }; }
+
+                    if (angle != 0.f) {
+                        for (Cell& cell : cells) cell.cube.rotate(angle, axis);
+                    }
+                }
+            }
+
+            for (auto& [index, moves] : solvers.takeSolutions()) {
+                Cell& cell{ cells[index] };
+                cell.phase = Cell::PLAYING;
+                solves++;
+
+                for (char move : moves) cell.cube.startRotation(move);
+            }
+
+            const float frameTime{ clock.restart().asSeconds() };
+
+            for (size_t i = 0; i < cells.size(); i++) {
+                Cell& cell{ cells[i] };
+                cell.cube.manageRotation(faceRotationSpeed * frameTime);
+
+                if (cell.cube.getState() != Cube::IDLE) continue;
+
+                if (cell.phase == Cell::SHUFFLING) {
+                    cell.phase = Cell::SOLVING;
+                    solvers.submit(static_cast<int>(i), cell.cube);
+                }
+                else if (cell.phase == Cell::PLAYING) {
+                    cell.phase = Cell::SHUFFLING;
+                    cell.cube.shuffle(shuffleLength);
+                }
+            }
+
+            batch.clear();
+
+            for (int row = 0; row < rows; row++) {
+                for (int column = 0; column < columns; column++) {
+                    batch.setOffset({ static_cast<float>(column * cellWidth), static_cast<float>(row * cellHeight) });
+                    cam.draw(batch, cells[row * columns + column].cube);
+                }
+            }
+
+            window.clear();
+            batch.drawTo(window);
+            window.display();
+
+            frames++;
+            if (const float elapsed{ statsClock.getElapsedTime().asSeconds() }; elapsed >= 1.f) {
+                window.setTitle(std::to_string(columns * rows) + " cubes, " + std::to_string(frames) + " fps, " +
+                    std::to_string(static_cast<int>((solves - solvesAtLastTitle) / elapsed)) + " solves/s, " + std::to_string(solves) + " solved");
+
+                solvesAtLastTitle = solves;
+                frames = 0;
+                statsClock.restart();
+            }
+        }
+    }
+}
@@ -0,0 +1,130 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <SFML/Graphics.hpp>
+
+// Key presses of a viewer session with the time they happened, so the session can be replayed headless by the
+// frame time benchmark. A trace is a text file: a "seed <n>" line with the seed of the session's random shuffles
+// and scrambles, then one "<seconds> <key>" line per key press, with " shift" appended if shift was held, e.g.
+//   seed 1234
+//   0.512 Right
+//   1.250 Space shift
+namespace InputTrace {
+    struct Event {
+        double seconds; // since the session started
+        sf::Keyboard::Scancode key;
+        bool shift;
+    };
+
+    struct Trace {
+        unsigned seed{ 0 };
+        std::vector<Event> events{};
+    };
+
+    // the keys the viewer reacts to
+    constexpr std::array<std::pair<sf::Keyboard::Scancode, std::string_view>, 21> keyNames{ {
+        { sf::Keyboard::Scancode::Up, "Up" },
+        { sf::Keyboard::Scancode::Down, "Down" },
+        { sf::Keyboard::Scancode::Left, "Left" },
+        { sf::Keyboard::Scancode::Right, "Right" },
+        { sf::Keyboard::Scancode::U, "U" },
+        { sf::Keyboard::Scancode::D, "D" },
+        { sf::Keyboard::Scancode::L, "L" },
+        { sf::Keyboard::Scancode::R, "R" },
+        { sf::Keyboard::Scancode::F, "F" },
+        { sf::Keyboard::Scancode::B, "B" },
+        { sf::Keyboard::Scancode::T, "T" },
+        { sf::Keyboard::Scancode::H, "H" },
+        { sf::Keyboard::Scancode::Space, "Space" },
+        { sf::Keyboard::Scancode::Enter, "Enter" },
+        { sf::Keyboard::Scancode::Num1, "1" },
+        { sf::Keyboard::Scancode::Num2, "2" },
+        { sf::Keyboard::Scancode::Num3, "3" },
+        { sf::Keyboard::Scancode::Num4, "4" },
+        { sf::Keyboard::Scancode::Num5, "5" },
+        { sf::Keyboard::Scancode::Num6, "6" },
+        { sf::Keyboard::Scancode::Num7, "7" }
+    } };
+
+    inline std::optional<std::string_view> keyName(sf::Keyboard::Scancode key) {
+        for (const auto& [code, name] : keyNames) {
+            if (code == key) return name;
+        }
+
+        return std::nullopt;
+    }
+
+    inline std::optional<sf::Keyboard::Scancode> keyFromName(std::string_view name) {
+        for (const auto& [code, keyName] : keyNames) {
+            if (keyName == name) return code;
+        }
+
+        return std::nullopt;
+    }
+
+    // writes every key press as it happens, so a session that crashes still leaves its trace
+    class Recorder {
+        std::ofstream m_out{};
+        std::chrono::steady_clock::time_point m_start{ std::chrono::steady_clock::now() };
+
+    public:
+        Recorder(const std::string& path, unsigned seed) : m_out(path) {
+            m_out << "seed " << seed << '\n' << std::fixed << std::setprecision(3);
+        }
+
+        bool isOpen() const {
+            return m_out.is_open();
+        }
+
+        // keys the viewer does not react to are left out
+        void record(sf::Keyboard::Scancode key, bool shift) {
+            const std::optional<std::string_view> name{ keyName(key) };
+            if (!name) return;
+
+            m_out << std::chrono::duration<double>(std::chrono::steady_clock::now() - m_start).count() << ' ' << *name << (shift ? " shift" : "") << std::endl;
+        }
+    };
+
+    // nothing if the file cannot be read or a line is not understood
+    inline std::optional<Trace> load(const std::string& path) {
+        std::ifstream in{ path };
+        if (!in) return std::nullopt;
+
+        Trace trace{};
+        std::string line{};
+
+        while (std::getline(in, line)) {
+            std::istringstream words{ line };
+            std::string first{}, second{}, third{};
+            if (!(words >> first)) continue; // blank line
+
+            if (first == "seed") {
+                if (!(words >> trace.seed)) return std::nullopt;
+                continue;
+            }
+
+            words >> second >> third;
+            const std::optional<sf::Keyboard::Scancode> key{ keyFromName(second) };
+            if (!key || (!third.empty() && third != "shift")) return std::nullopt;
+
+            try {
+                trace.events.push_back({ std::stod(first), *key, third == "shift" });
+            }
+            catch (const std::exception&) {
+                return std::nullopt;
+            }
+        }
+
+        return trace;
+    }
+}
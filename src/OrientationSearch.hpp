@@ -0,0 +1,160 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <thread>
+#include <vector>
+
+#include "Cube.hpp"
+#include "FaceletCube.hpp"
+#include "Solver.hpp"
+
+// Two-phase solve time depends heavily on which axis plays UD. These searches run the cube in its three axis
+// orientations, each also as the inverse cube, on six threads sharing one set of tables, and map the
+// winning solution back to the original cube.
+namespace Solver {
+    enum SearchMode {
+        FIRST,   // return as soon as any search finishes
+        SHORTEST // wait for all six and keep the shortest solution
+    };
+
+    // a whole-cube rotation: where every sticker goes and which face each face ends up on
+    struct Orientation {
+        std::array<std::uint8_t, FaceletCube::numFacelets> source{}; // sticker i comes from sticker source[i]
+        std::array<int, 6> faceMap{};                                // face f moves to face faceMap[f]
+    };
+
+    // identity, then rotations turning the F/B axis and the R/L axis into the U/D axis
+    const std::array<Orientation, 3>& orientations() {
+        static const std::array<Orientation, 3> result{ [] {
+            std::array<Orientation, 3> rotations{};
+            const std::array<char, 3> axis{ ' ', 'R', 'F' }; // x turns like R and brings F to U, z turns like F and brings L to U
+
+            for (int r = 0; r < 3; r++) {
+                Cube cube{ 0.f };
+
+                for (int i = 0; i < FaceletCube::numFacelets; i++) {
+                    cube.faceColors[i / 9][(i % 9) / 3][i % 3] = sf::Color{ static_cast<std::uint8_t>(i), 0, 0 };
+                }
+
+                if (r != 0) {
+                    for (int layer = 0; layer < 3; layer++) cube.turn(axis[r], layer);
+                }
+
+                for (int i = 0; i < FaceletCube::numFacelets; i++) {
+                    rotations[r].source[i] = cube.faceColors[i / 9][(i % 9) / 3][i % 3].r;
+                }
+
+                for (int face = 0; face < 6; face++) {
+                    for (int i = 0; i < 6; i++) {
+                        if (rotations[r].source[i * 9 + 4] == face * 9 + 4) rotations[r].faceMap[face] = i;
+                    }
+                }
+            }
+
+            return rotations;
+            }() };
+
+        return result;
+    }
+
+    // the same cube seen after the rotation, recoloured so the centers are back to the standard colours
+    FaceletCube reorient(const FaceletCube& cube, const Orientation& orientation) {
+        FaceletCube result{};
+
+        for (int i = 0; i < FaceletCube::numFacelets; i++) {
+            result.facelets[i] = static_cast<std::uint8_t>(orientation.faceMap[cube.facelets[orientation.source[i]]]);
+        }
+
+        return result;
+    }
+
+    // turns found on the reoriented cube as turns of the original one
+    std::vector<int> undoReorientation(const std::vector<int>& moves, const Orientation& orientation) {
+        std::array<int, 6> originalFace{};
+        for (int face = 0; face < 6; face++) originalFace[orientation.faceMap[face]] = face;
+
+        std::vector<int> result{};
+        for (int move : moves) result.push_back(originalFace[move / 3] * 3 + move % 3);
+
+        return result;
+    }
+
+    std::vector<int> invertFaceTurns(const std::vector<int>& moves) {
+        std::vector<int> result{};
+        for (auto it = moves.rbegin(); it != moves.rend(); it++) result.push_back(*it / 3 * 3 + (2 - *it % 3));
+
+        return result;
+    }
+
+    // the six searches on their own threads, each run with the options (deadline, token, target length and so on,
+    // but not onPhase1); moves holds the shortest solution any search found, and the status is SOLVED as soon as one
+    // search finished. Every call starts six threads, each with options.phase2Threads more, on top of whatever
+    // threads the caller runs, so callers solving in parallel should run fewer solves at a time.
+    SolveResult solveAllOrientationsWithOptions(const Cube& cube, SearchMode mode, const SolveOptions& options, const Tables& tables = getTables()) {
+        SolveResult result{};
+        CubieCube cubies{};
+
+        if (result.validity = validate(FaceletCube::fromFaceColors(cube.faceColors), &cubies); result.validity != VALID) {
+            result.status = INVALID_CUBE;
+            return result;
+        }
+
+        const std::array<FaceletCube, 2> starts{ cubies.toFaceletCube(), cubies.inverse().toFaceletCube() };
+
+        std::array<SolveResult, 6> results{};
+        CancellationToken firstFinished{ options.token }; // cancelled by the caller's token too
+        std::vector<std::thread> threads{};
+
+        for (int search = 0; search < 6; search++) {
+            threads.emplace_back([&, search] {
+                const Orientation& orientation{ orientations()[search / 2] };
+                const bool inverse{ search % 2 == 1 };
+
+                Cube searchCube{ 0.f };
+                searchCube.faceColors = reorient(starts[inverse], orientation).toFaceColors();
+
+                SolveOptions searchOptions{ options };
+                searchOptions.token = mode == FIRST ? &firstFinished : options.token;
+                searchOptions.onPhase1 = nullptr;
+
+                SolveResult& searchResult{ results[search] };
+                searchResult = solveWithOptions(searchCube, searchOptions, tables);
+                if (!searchResult.moves) return;
+
+                searchResult.moves = undoReorientation(*searchResult.moves, orientation);
+                if (inverse) searchResult.moves = invertFaceTurns(*searchResult.moves); // the inverse of the inverse cube's solution solves the cube
+
+                if (mode == FIRST && searchResult.status == SOLVED) firstFinished.cancel();
+                });
+        }
+
+        for (auto& thread : threads) thread.join();
+
+        bool solved{ false };
+        bool stopped{ false }; // by the deadline or the caller's token
+
+        for (const SolveResult& searchResult : results) {
+            if (searchResult.moves && (!result.moves || searchResult.moves->size() < result.moves->size())) result.moves = searchResult.moves;
+            solved = solved || searchResult.status == SOLVED;
+            stopped = stopped || searchResult.status == TIMED_OUT || searchResult.status == CANCELLED;
+
+            result.stats.phase1Nodes += searchResult.stats.phase1Nodes;
+            result.stats.phase2Nodes += searchResult.stats.phase2Nodes;
+            result.stats.phase1Seconds += searchResult.stats.phase1Seconds;
+            result.stats.phase2Seconds += searchResult.stats.phase2Seconds;
+            result.stats.phase1Solutions += searchResult.stats.phase1Solutions;
+        }
+
+        if (!solved) result.status = options.token && options.token->isCancelled() ? CANCELLED : stopped ? TIMED_OUT : NOT_FOUND;
+        return result;
+    }
+
+    // solves with the six searches on their own threads; returns quarter turns like solve(), nothing for an
+    // invalid cube, and prints nothing
+    std::vector<char> solveAllOrientations(const Cube& cube, SearchMode mode = FIRST, const Tables& tables = getTables()) {
+        const SolveResult result{ solveAllOrientationsWithOptions(cube, mode, {}, tables) };
+        return result.moves ? toQuarterTurns(*result.moves) : std::vector<char>{};
+    }
+}
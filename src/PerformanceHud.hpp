@@ -0,0 +1,174 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <iomanip>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <SFML/Graphics.hpp>
+
+#include "RingBuffer.hpp"
+#include "Solver.hpp"
+
+// Overlay with frame rate and frame time percentiles, the animation queue, the last solve's phase times and node
+// counts, and the table memory. Text is drawn with a built-in 5x7 pixel font as one vertex array, so no font file
+// is needed.
+class PerformanceHud {
+    static constexpr size_t frameWindow{ 120 }; // percentiles over the last two seconds at 60 fps
+    static constexpr float pixelSize{ 2.f };
+    static constexpr float margin{ 8.f };
+
+    static constexpr std::string_view glyphCharacters{ " 0123456789.:/%-+()ABCDEFGHIJKLMNOPQRSTUVWXYZ" };
+
+    // rows top to bottom, bit 4 is the leftmost pixel
+    static constexpr std::array<std::array<std::uint8_t, 7>, 45> glyphs{ {
+        { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, // space
+        { 0x0E, 0x11, 0x13, 0x15, 0x19, 0x11, 0x0E }, // 0
+        { 0x04, 0x0C, 0x04, 0x04, 0x04, 0x04, 0x0E },
+        { 0x0E, 0x11, 0x01, 0x02, 0x04, 0x08, 0x1F },
+        { 0x1F, 0x02, 0x04, 0x02, 0x01, 0x11, 0x0E },
+        { 0x02, 0x06, 0x0A, 0x12, 0x1F, 0x02, 0x02 },
+        { 0x1F, 0x10, 0x1E, 0x01, 0x01, 0x11, 0x0E },
+        { 0x06, 0x08, 0x10, 0x1E, 0x11, 0x11, 0x0E },
+        { 0x1F, 0x01, 0x02, 0x04, 0x08, 0x08, 0x08 },
+        { 0x0E, 0x11, 0x11, 0x0E, 0x11, 0x11, 0x0E },
+        { 0x0E, 0x11, 0x11, 0x0F, 0x01, 0x02, 0x0C }, // 9
+        { 0x00, 0x00, 0x00, 0x00, 0x00, 0x0C, 0x0C }, // .
+        { 0x00, 0x0C, 0x0C, 0x00, 0x0C, 0x0C, 0x00 }, // :
+        { 0x00, 0x01, 0x02, 0x04, 0x08, 0x10, 0x00 }, // /
+        { 0x18, 0x19, 0x02, 0x04, 0x08, 0x13, 0x03 }, // %
+        { 0x00, 0x00, 0x00, 0x1F, 0x00, 0x00, 0x00 }, // -
+        { 0x00, 0x04, 0x04, 0x1F, 0x04, 0x04, 0x00 }, // +
+        { 0x02, 0x04, 0x08, 0x08, 0x08, 0x04, 0x02 }, // (
+        { 0x08, 0x04, 0x02, 0x02, 0x02, 0x04, 0x08 }, // )
+        { 0x0E, 0x11, 0x11, 0x1F, 0x11, 0x11, 0x11 }, // A
+        { 0x1E, 0x11, 0x11, 0x1E, 0x11, 0x11, 0x1E },
+        { 0x0E, 0x11, 0x10, 0x10, 0x10, 0x11, 0x0E },
+        { 0x1C, 0x12, 0x11, 0x11, 0x11, 0x12, 0x1C },
+        { 0x1F, 0x10, 0x10, 0x1E, 0x10, 0x10, 0x1F },
+        { 0x1F, 0x10, 0x10, 0x1E, 0x10, 0x10, 0x10 },
+        { 0x0E, 0x11, 0x10, 0x17, 0x11, 0x11, 0x0F },
+        { 0x11, 0x11, 0x11, 0x1F, 0x11, 0x11, 0x11 },
+        { 0x0E, 0x04, 0x04, 0x04, 0x04, 0x04, 0x0E },
+        { 0x07, 0x02, 0x02, 0x02, 0x02, 0x12, 0x0C },
+        { 0x11, 0x12, 0x14, 0x18, 0x14, 0x12, 0x11 },
+        { 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x1F },
+        { 0x11, 0x1B, 0x15, 0x15, 0x11, 0x11, 0x11 },
+        { 0x11, 0x11, 0x19, 0x15, 0x13, 0x11, 0x11 },
+        { 0x0E, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E },
+        { 0x1E, 0x11, 0x11, 0x1E, 0x10, 0x10, 0x10 },
+        { 0x0E, 0x11, 0x11, 0x11, 0x15, 0x12, 0x0D },
+        { 0x1E, 0x11, 0x11, 0x1E, 0x14, 0x12, 0x11 },
+        { 0x0F, 0x10, 0x10, 0x0E, 0x01, 0x01, 0x1E },
+        { 0x1F, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04 },
+        { 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E },
+        { 0x11, 0x11, 0x11, 0x11, 0x11, 0x0A, 0x04 },
+        { 0x11, 0x11, 0x11, 0x15, 0x15, 0x15, 0x0A },
+        { 0x11, 0x11, 0x0A, 0x04, 0x0A, 0x11, 0x11 },
+        { 0x11, 0x11, 0x11, 0x0A, 0x04, 0x04, 0x04 },
+        { 0x1F, 0x01, 0x02, 0x04, 0x08, 0x10, 0x1F }  // Z
+    } };
+
+    RingBuffer<float> m_frameTimes{}; // seconds
+    std::optional<Solver::SolveStats> m_solve{};
+    sf::VertexArray m_vertices{ sf::PrimitiveType::Triangles };
+
+    void rectangle(sf::Vector2f position, sf::Vector2f size, sf::Color color) {
+        const sf::Vector2f corners[4]{ position, position + sf::Vector2f{ size.x, 0.f }, position + size, position + sf::Vector2f{ 0.f, size.y } };
+
+        for (int i : { 0, 1, 2, 0, 2, 3 }) {
+            m_vertices.append({ corners[i], color });
+        }
+    }
+
+    // upper case text; characters without a glyph are left blank
+    void text(sf::Vector2f position, std::string_view line, sf::Color color) {
+        for (char c : line) {
+            if (c >= 'a' && c <= 'z') c = static_cast<char>(c - 'a' + 'A');
+            const size_t glyph{ glyphCharacters.find(c) };
+
+            for (int row = 0; row < 7 && glyph != std::string_view::npos; row++) {
+                for (int column = 0; column < 5; column++) {
+                    if (glyphs[glyph][row] & (0x10 >> column)) {
+                        rectangle(position + sf::Vector2f{ column * pixelSize, row * pixelSize }, { pixelSize, pixelSize }, color);
+                    }
+                }
+            }
+
+            position.x += 6 * pixelSize;
+        }
+    }
+
+    static std::string fixed(double value, int decimals) {
+        std::ostringstream out{};
+        out << std::fixed << std::setprecision(decimals) << value;
+        return out.str();
+    }
+
+    // frame time at the given fraction of the sorted window, in milliseconds
+    static float percentile(const std::vector<float>& sorted, float fraction) {
+        return sorted[std::min(sorted.size() - 1, static_cast<size_t>(fraction * sorted.size()))] * 1000.f;
+    }
+
+public:
+    void addFrame(float seconds) {
+        m_frameTimes.push_back(seconds);
+        if (m_frameTimes.size() > frameWindow) m_frameTimes.pop_front();
+    }
+
+    void setSolveStats(const Solver::SolveStats& stats) {
+        m_solve = stats;
+    }
+
+    // tableBytes is left out if no tables are loaded
+    void draw(sf::RenderTarget& target, size_t queueLength, std::optional<size_t> tableBytes) {
+        std::vector<std::string> lines{};
+
+        if (!m_frameTimes.empty()) {
+            std::vector<float> sorted(m_frameTimes.size());
+            float total{ 0.f };
+
+            for (size_t i = 0; i < m_frameTimes.size(); i++) {
+                sorted[i] = m_frameTimes[i];
+                total += m_frameTimes[i];
+            }
+
+            std::sort(sorted.begin(), sorted.end());
+
+            lines.push_back("fps " + fixed(total > 0.f ? sorted.size() / total : 0.f, 0) + "  frame p50 " + fixed(percentile(sorted, .5f), 1) +
+                " p90 " + fixed(percentile(sorted, .9f), 1) + " p99 " + fixed(percentile(sorted, .99f), 1) + " ms");
+        }
+
+        lines.push_back("queue " + std::to_string(queueLength) + " turns");
+
+        if (m_solve) {
+            const double seconds{ m_solve->phase1Seconds + m_solve->phase2Seconds };
+            const long long nodes{ m_solve->phase1Nodes + m_solve->phase2Nodes };
+
+            lines.push_back("solve " + fixed(seconds * 1000.0, 1) + " ms: phase 1 " + fixed(m_solve->phase1Seconds * 1000.0, 1) +
+                " phase 2 " + fixed(m_solve->phase2Seconds * 1000.0, 1));
+            lines.push_back("nodes " + std::to_string(nodes) + " (" + std::to_string(m_solve->phase1Nodes) + " + " + std::to_string(m_solve->phase2Nodes) +
+                ")  " + fixed(seconds > 0.0 ? nodes / seconds / 1e6 : 0.0, 1) + "M/s");
+        }
+
+        if (tableBytes) lines.push_back("tables " + fixed(*tableBytes / (1024.0 * 1024.0), 1) + " MB");
+
+        size_t longest{ 0 };
+        for (const std::string& line : lines) longest = std::max(longest, line.size());
+
+        const float lineHeight{ 10 * pixelSize };
+        m_vertices.clear();
+        rectangle({ margin, margin }, { longest * 6 * pixelSize + 2 * margin, lines.size() * lineHeight + 2 * margin - 3 * pixelSize }, sf::Color{ 0, 0, 0, 160 });
+
+        for (size_t i = 0; i < lines.size(); i++) {
+            text({ 2 * margin, 2 * margin + i * lineHeight }, lines[i], sf::Color::White);
+        }
+
+        target.draw(m_vertices);
+    }
+};
@@ -2,10 +2,13 @@
 
 #include <array>
 #include <cassert>
+#include <tuple>
+#include <utility>
 
 #include <SFML/Graphics.hpp>
 
-constexpr int numSides{ 3 };
+constexpr int minSides{ 2 };
+constexpr int maxSides{ 7 };
 
 constexpr std::array<sf::Color, 6> defaultFaceColors{
     sf::Color::Red,
@@ -16,10 +19,27 @@ constexpr std::array<sf::Color, 6> defaultFaceColors{
     sf::Color::Yellow
 };
 
-using FaceColors = std::array<std::array<std::array<sf::Color, numSides>, numSides>, 6>;
+template <int N>
+using BasicFaceColors = std::array<std::array<std::array<sf::Color, N>, N>, 6>;
+
+using FaceColors = BasicFaceColors<3>;
 using Vertices = std::array<sf::Vector3f, 8>;
 
-class RenderCube {
+template <typename Func, int... I>
+inline void unrollImpl(Func& func, std::integer_sequence<int, I...>) {
+    (func(std::integral_constant<int, I>{}), ...);
+}
+
+// calls func(std::integral_constant<int, i>) for i in [0, Count) with the loop expanded at compile time
+template <int Count, typename Func>
+inline void unroll(Func&& func) {
+    unrollImpl(func, std::make_integer_sequence<int, Count>{});
+}
+
+template <int N>
+class BasicRenderCube {
+    static_assert(N >= minSides && N <= maxSides, "Unsupported cube size");
+
 protected:
     float m_cubeletSize{ 10.f };
 
@@ -44,14 +64,16 @@ protected:
         for (int t = 0; t < 8; t++) {
             auto [a, b, c] = vertexOffsets[t];
 
-            m_vertices[t] = ((m_cubeletSize * numSides) / 2.f) * (static_cast<float>(a) * m_i +
+            m_vertices[t] = ((m_cubeletSize * N) / 2.f) * (static_cast<float>(a) * m_i +
                 static_cast<float>(b) * m_j +
                 static_cast<float>(c) * m_k);
         }
     }
 
 public:
-    FaceColors faceColors;
+    static constexpr int numSides{ N };
+
+    BasicFaceColors<N> faceColors;
 
     static constexpr std::array<std::array<int, 4>, 6> faceVertexData{ {
         { 0, 1, 2, 3 }, // front
@@ -62,12 +84,12 @@ public:
         { 3, 2, 6, 7 } // bottom
     } };
 
-    RenderCube(float cubeletSize = 5.f) : m_cubeletSize(cubeletSize) {
+    BasicRenderCube(float cubeletSize = 5.f) : m_cubeletSize(cubeletSize) {
         setFaceColorDefault();
         updateVertexPositions();
     }
 
-    RenderCube(float cubeletSize, sf::Vector3f i, sf::Vector3f j, sf::Vector3f k) :
+    BasicRenderCube(float cubeletSize, sf::Vector3f i, sf::Vector3f j, sf::Vector3f k) :
         m_cubeletSize(cubeletSize), m_i(i), m_j(j), m_k(k) {
         setFaceColorDefault();
         updateVertexPositions();
@@ -86,8 +108,8 @@ public:
 
     void setFaceColorDefault() {
         for (int i = 0; i < 6; i++) {
-            for (int j = 0; j < numSides; j++) {
-                for (int k = 0; k < numSides; k++) {
+            for (int j = 0; j < N; j++) {
+                for (int k = 0; k < N; k++) {
                     faceColors[i][j][k] = defaultFaceColors[i];
                 }
             }
@@ -96,8 +118,8 @@ public:
 
     void setFaceColorEmpty() {
         for (int i = 0; i < 6; i++) {
-            for (int j = 0; j < numSides; j++) {
-                for (int k = 0; k < numSides; k++) {
+            for (int j = 0; j < N; j++) {
+                for (int k = 0; k < N; k++) {
                     faceColors[i][j][k] = sf::Color::Black;
                 }
             }
@@ -122,3 +144,5 @@ public:
         return m_vertices;
     }
 };
+
+using RenderCube = BasicRenderCube<3>;
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+// first-in first-out queue on a ring whose size is a power of two, doubled when full; pushing and popping are O(1)
+template <typename T>
+class RingBuffer {
+    std::vector<T> m_items{};
+    size_t m_head{ 0 };
+    size_t m_size{ 0 };
+
+    void grow() {
+        std::vector<T> items(m_items.empty() ? 16 : m_items.size() * 2);
+
+        for (size_t i = 0; i < m_size; i++) {
+            items[i] = std::move((*this)[i]);
+        }
+
+        m_items = std::move(items);
+        m_head = 0;
+    }
+
+public:
+    bool empty() const {
+        return m_size == 0;
+    }
+
+    size_t size() const {
+        return m_size;
+    }
+
+    // i-th item from the front
+    T& operator[](size_t i) {
+        return m_items[(m_head + i) & (m_items.size() - 1)];
+    }
+
+    const T& operator[](size_t i) const {
+        return m_items[(m_head + i) & (m_items.size() - 1)];
+    }
+
+    T& front() {
+        assert(m_size > 0);
+        return m_items[m_head];
+    }
+
+    const T& front() const {
+        assert(m_size > 0);
+        return m_items[m_head];
+    }
+
+    void push_back(const T& item) {
+        if (m_size == m_items.size()) grow();
+
+        (*this)[m_size] = item;
+        m_size++;
+    }
+
+    void pop_front() {
+        assert(m_size > 0);
+        m_head = (m_head + 1) & (m_items.size() - 1);
+        m_size--;
+    }
+
+    void clear() {
+        m_head = 0;
+        m_size = 0;
+    }
+};
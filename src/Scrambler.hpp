@@ -0,0 +1,116 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "FaceletCube.hpp"
+#include "Solver.hpp"
+
+namespace Scrambler {
+    struct Scramble {
+        FaceletCube state;
+        std::vector<char> moves; // quarter turns taking the solved cube to state
+    };
+
+    // reverses a quarter turn sequence, merging runs of the same face first so R R R undoes to R
+    std::vector<char> invertMoves(const std::vector<char>& moves) {
+        std::vector<char> inverse{};
+
+        for (int i = static_cast<int>(moves.size()) - 1; i >= 0;) {
+            int run{ 0 };
+            const char face{ moves[i] };
+
+            while (i >= 0 && moves[i] == face) {
+                run++;
+                i--;
+            }
+
+            for (int k = 0; k < (4 - run % 4) % 4; k++) {
+                inverse.push_back(face);
+            }
+        }
+
+        return inverse;
+    }
+
+    // draws states uniformly from the 43 quintillion reachable ones by sampling the twist, flip and both
+    // permutations independently, then fixing the last corner twist, last edge flip and edge parity
+    class Generator {
+        std::mt19937_64 m_rng;
+
+        int uniform(int n) {
+            return std::uniform_int_distribution<int>{ 0, n - 1 }(m_rng);
+        }
+
+        template <std::size_t Size>
+        int shuffle(std::array<std::uint8_t, Size>& permutation) {
+            int parity{ 0 };
+
+            for (int i = Size - 1; i > 0; i--) {
+                const int j{ uniform(i + 1) };
+
+                if (j != i) {
+                    std::swap(permutation[i], permutation[j]);
+                    parity ^= 1;
+                }
+            }
+
+            return parity;
+        }
+
+    public:
+        Generator(std::uint64_t seed = 0) : m_rng(seed) {}
+
+        Solver::CubieCube nextCubies() {
+            Solver::CubieCube cubies{};
+
+            int twist{ uniform(2187) };
+            int twistSum{ 0 };
+            for (int i = 6; i >= 0; i--) {
+                cubies.co[i] = twist % 3;
+                twistSum += twist % 3;
+                twist /= 3;
+            }
+            cubies.co[7] = (3 - twistSum % 3) % 3;
+
+            int flip{ uniform(2048) };
+            int flipSum{ 0 };
+            for (int i = 10; i >= 0; i--) {
+                cubies.eo[i] = flip % 2;
+                flipSum += flip % 2;
+                flip /= 2;
+            }
+            cubies.eo[11] = flipSum % 2;
+
+            const int cornerParity{ shuffle(cubies.cp) };
+            const int edgeParity{ shuffle(cubies.ep) };
+
+            if (cornerParity != edgeParity) {
+                std::swap(cubies.ep[10], cubies.ep[11]);
+            }
+
+            return cubies;
+        }
+
+        FaceletCube nextState() {
+            return nextCubies().toFaceletCube();
+        }
+
+        // also finds a sequence reaching the state, which costs a full solve per scramble; moves stay empty if the
+        // solve finds nothing, which only happens with missing tables
+        Scramble next(const Solver::Tables& tables = Solver::getTables()) {
+            Scramble scramble{ nextState(), {} };
+
+            Cube cube{ 0.f };
+            cube.faceColors = scramble.state.toFaceColors();
+
+            const Solver::SolveResult result{ Solver::solveWithOptions(cube, {}, tables) };
+            if (result.moves) scramble.moves = invertMoves(Solver::toQuarterTurns(*result.moves));
+
+            return scramble;
+        }
+    };
+}
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <cmath>
+#include <vector>
+
+#include <SFML/Graphics.hpp>
+
+// Collects the camera's sticker polygons as triangles in one vertex array, so any number of cubes is drawn with a
+// single draw call. Shapes are taken as the camera builds them: convex, untransformed, outline drawn inwards; an
+// offset moves everything appended after it, e.g. into one cell of a grid.
+class ShapeBatch {
+    sf::VertexArray m_vertices{ sf::PrimitiveType::Triangles };
+    sf::Vector2f m_offset{};
+
+    void triangle(sf::Vector2f a, sf::Vector2f b, sf::Vector2f c, sf::Color color) {
+        m_vertices.append({ a + m_offset, color });
+        m_vertices.append({ b + m_offset, color });
+        m_vertices.append({ c + m_offset, color });
+    }
+
+public:
+    void clear() {
+        m_vertices.clear();
+    }
+
+    void setOffset(sf::Vector2f offset) {
+        m_offset = offset;
+    }
+
+    void draw(const sf::ConvexShape& shape) {
+        const size_t pointCount{ shape.getPointCount() };
+        if (pointCount < 3) return;
+
+        std::vector<sf::Vector2f> outer{};
+        float area{ 0.f };
+
+        for (size_t i = 0; i < pointCount; i++) {
+            outer.push_back(shape.getPoint(i));
+        }
+
+        for (size_t i = 0; i < pointCount; i++) {
+            area += outer[i].x * outer[(i + 1) % pointCount].y - outer[(i + 1) % pointCount].x * outer[i].y;
+        }
+
+        for (size_t i = 1; i + 1 < pointCount; i++) {
+            triangle(outer[0], outer[i], outer[i + 1], shape.getFillColor());
+        }
+
+        const float thickness{ -shape.getOutlineThickness() }; // negative thickness is drawn inside the shape
+        if (thickness <= 0.f || area == 0.f) return;
+
+        // the outline is the ring between the shape and a copy with every edge moved inwards by the thickness
+        const float sign{ area > 0.f ? 1.f : -1.f };
+        std::vector<sf::Vector2f> inner(pointCount);
+
+        for (size_t i = 0; i < pointCount; i++) {
+            const sf::Vector2f& previous{ outer[(i + pointCount - 1) % pointCount] };
+            const sf::Vector2f& current{ outer[i] };
+            const sf::Vector2f& next{ outer[(i + 1) % pointCount] };
+
+            const sf::Vector2f in{ current - previous };
+            const sf::Vector2f out{ next - current };
+            const float inLength{ std::sqrt(in.x * in.x + in.y * in.y) };
+            const float outLength{ std::sqrt(out.x * out.x + out.y * out.y) };
+
+            if (inLength == 0.f || outLength == 0.f) {
+                inner[i] = current;
+                continue;
+            }
+
+            const sf::Vector2f inNormal{ -in.y / inLength * sign, in.x / inLength * sign };
+            const sf::Vector2f outNormal{ -out.y / outLength * sign, out.x / outLength * sign };
+
+            // where the two moved edges cross: the corner moves along the sum of the normals, scaled for the angle
+            const sf::Vector2f bisector{ inNormal + outNormal };
+            const float cosine{ bisector.x * outNormal.x + bisector.y * outNormal.y };
+
+            inner[i] = cosine > 0.1f ? current + bisector * (thickness / cosine) : current + outNormal * thickness;
+        }
+
+        for (size_t i = 0; i < pointCount; i++) {
+            const size_t next{ (i + 1) % pointCount };
+            triangle(outer[i], outer[next], inner[next], shape.getOutlineColor());
+            triangle(outer[i], inner[next], inner[i], shape.getOutlineColor());
+        }
+    }
+
+    size_t getVertexCount() const {
+        return m_vertices.getVertexCount();
+    }
+
+    void drawTo(sf::RenderTarget& target) const {
+        target.draw(m_vertices);
+    }
+};
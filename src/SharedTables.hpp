@@ -0,0 +1,228 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <string>
+#include <thread>
+#include <type_traits>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <cerrno>
+#include <csignal>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define CUBE_SHARED_TABLES 1
+#endif
+
+#include "Solver.hpp"
+
+// Tables published once per host in a POSIX shared memory segment. The first process to ask creates the
+// segment, loads the table files and the endgame table into it and marks it ready; every later process maps it
+// read-only, so memory use stays constant as solver processes are added and they start without reading any file.
+namespace Solver {
+    struct SharedTablesHeader {
+        static constexpr std::uint64_t expectedMagic{ 0x3473656c62615443 }; // "CTables4"
+
+        std::uint64_t magic;
+        std::atomic<std::uint32_t> ready;
+        std::uint32_t count;
+        std::int64_t publisher;     // pid of the process filling the segment, written before anything else
+        std::array<std::uint64_t, numTables> offsets; // in bytes from the start of the segment
+        std::uint64_t endgameOffset;
+        std::uint64_t endgameSlots; // 0 without phase2Endgame.bin
+        std::int32_t endgameDepth;
+        std::uint64_t size;         // of the whole segment
+    };
+
+    constexpr size_t sharedTablesAlignment{ 64 };
+
+    constexpr size_t alignShared(size_t bytes) {
+        return (bytes + sharedTablesAlignment - 1) / sharedTablesAlignment * sharedTablesAlignment;
+    }
+
+    // the size of the segment without the endgame table, which starts there
+    size_t sharedTablesSize(std::array<std::uint64_t, numTables>& offsets) {
+        size_t size{ alignShared(sizeof(SharedTablesHeader)) };
+        size_t i{ 0 };
+
+        Tables layout{};
+        forEachTable(layout, [&](auto& table, const char*, int length) {
+            using TableType = std::decay_t<decltype(table)>;
+            const size_t bytes{ length * TableType::entriesPerCoord * sizeof(typename TableType::value_type) };
+
+            offsets[i++] = size;
+            size += alignShared(bytes);
+            });
+
+        return size;
+    }
+
+#ifdef CUBE_SHARED_TABLES
+    Tables tablesFromMapping(const void* mapping, size_t size) {
+        const auto* header{ static_cast<const SharedTablesHeader*>(mapping) };
+        const auto* bytes{ static_cast<const char*>(mapping) };
+
+        const std::shared_ptr<const void> storage{ mapping, [size](const void* address) { munmap(const_cast<void*>(address), size); } };
+
+        Tables tables{};
+        size_t i{ 0 };
+
+        forEachTable(tables, [&](auto& table, const char*, int length) {
+            using TableType = std::decay_t<decltype(table)>;
+            table = TableType{ storage, reinterpret_cast<const typename TableType::value_type*>(bytes + header->offsets[i++]), static_cast<size_t>(length) };
+            });
+
+        if (header->endgameSlots > 0) {
+            tables.endgame2 = EndgameTable{ storage, reinterpret_cast<const std::uint64_t*>(bytes + header->endgameOffset), header->endgameSlots, header->endgameDepth };
+        }
+
+        return tables;
+    }
+
+    constexpr size_t sharedHeaderBytes{ alignShared(sizeof(SharedTablesHeader)) };
+
+    // true if the process filling the segment died before marking it ready, so nobody will finish it
+    bool publisherDied(const SharedTablesHeader& header) {
+        return header.ready.load(std::memory_order_acquire) == 0 && header.publisher > 0 &&
+            kill(static_cast<pid_t>(header.publisher), 0) != 0 && errno == ESRCH;
+    }
+
+    // creates and fills the segment, or returns false if another process already did (or is doing) it
+    bool publishSharedTables(const std::string& name, const std::filesystem::path& directory) {
+        const int fd{ shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644) };
+        if (fd < 0) return false;
+
+        // first just the header with our pid, so waiting processes can tell if we die while loading
+        void* headerMapping{ ftruncate(fd, sharedHeaderBytes) == 0 ? mmap(nullptr, sharedHeaderBytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0) : MAP_FAILED };
+
+        if (headerMapping == MAP_FAILED) {
+            close(fd);
+            shm_unlink(name.c_str());
+            return false;
+        }
+
+        new (headerMapping) SharedTablesHeader{};
+        static_cast<SharedTablesHeader*>(headerMapping)->publisher = getpid();
+        munmap(headerMapping, sharedHeaderBytes);
+
+        const Tables tables{ loadTables(directory) }; // before sizing the segment, which depends on the endgame table
+
+        std::array<std::uint64_t, numTables> offsets{};
+        const size_t endgameOffset{ sharedTablesSize(offsets) };
+        const size_t size{ endgameOffset + alignShared(tables.endgame2.getBytes()) };
+
+        void* mapping{ ftruncate(fd, size) == 0 ? mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0) : MAP_FAILED };
+        close(fd);
+
+        if (mapping == MAP_FAILED) {
+            shm_unlink(name.c_str());
+            return false;
+        }
+
+        auto* header{ static_cast<SharedTablesHeader*>(mapping) };
+        header->magic = SharedTablesHeader::expectedMagic;
+        header->count = numTables;
+        header->offsets = offsets;
+        header->endgameOffset = endgameOffset;
+        header->endgameSlots = tables.endgame2.size();
+        header->endgameDepth = tables.endgame2.getDepth();
+        header->size = size;
+
+        size_t i{ 0 };
+
+        forEachTable(tables, [&](const auto& table, const char*, int) {
+            std::memcpy(static_cast<char*>(mapping) + offsets[i++], table.data(), table.size() * sizeof(table[0]));
+            });
+
+        if (!tables.endgame2.empty()) std::memcpy(static_cast<char*>(mapping) + endgameOffset, tables.endgame2.data(), tables.endgame2.getBytes());
+
+        header->ready.store(1, std::memory_order_release);
+        munmap(mapping, size);
+
+        return true;
+    }
+
+    // maps the segment read-only, waiting up to 30 s for a publisher that is still filling it. A segment whose
+    // publisher died first is removed, so the caller can publish it again.
+    bool attachSharedTables(const std::string& name, Tables& tables) {
+        const int fd{ shm_open(name.c_str(), O_RDONLY, 0) };
+        if (fd < 0) return false;
+
+        std::array<std::uint64_t, numTables> offsets{};
+        const size_t minimumSize{ sharedTablesSize(offsets) };
+
+        struct stat info {};
+        bool stale{ false };
+
+        for (int attempt = 0; fstat(fd, &info) == 0 && static_cast<size_t>(info.st_size) < minimumSize; attempt++) { // the publisher is still loading
+            if (static_cast<size_t>(info.st_size) >= sharedHeaderBytes) {
+                void* headerMapping{ mmap(nullptr, sharedHeaderBytes, PROT_READ, MAP_SHARED, fd, 0) };
+                stale = headerMapping != MAP_FAILED && publisherDied(*static_cast<const SharedTablesHeader*>(headerMapping));
+                if (headerMapping != MAP_FAILED) munmap(headerMapping, sharedHeaderBytes);
+            }
+            else {
+                stale = attempt >= 3000; // never even sized: the publisher died right after creating it
+            }
+
+            if (stale || attempt >= 3000) break;
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+
+        const size_t size{ static_cast<size_t>(info.st_size) };
+        void* mapping{ !stale && size >= minimumSize ? mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0) : MAP_FAILED };
+        close(fd);
+
+        if (stale) shm_unlink(name.c_str());
+        if (mapping == MAP_FAILED) return false;
+
+        const auto* header{ static_cast<const SharedTablesHeader*>(mapping) };
+
+        for (int attempt = 0; attempt < 3000 && header->ready.load(std::memory_order_acquire) == 0; attempt++) {
+            if (publisherDied(*header)) {
+                munmap(mapping, size);
+                shm_unlink(name.c_str());
+                return false;
+            }
+
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+
+        if (header->magic != SharedTablesHeader::expectedMagic || header->count != numTables || header->ready.load(std::memory_order_acquire) == 0 || header->size != size) {
+            munmap(mapping, size);
+            return false;
+        }
+
+        tables = tablesFromMapping(mapping, size);
+        return true;
+    }
+#endif
+
+    // tables backed by the host-wide segment called name (e.g. "/cubesolver-tables"), publishing it from the table
+    // files in directory if no process has yet; falls back to private tables if shared memory is unavailable
+    Tables loadSharedTables(const std::string& name, const std::filesystem::path& directory = ".") {
+#ifdef CUBE_SHARED_TABLES
+        Tables tables{};
+
+        if (attachSharedTables(name, tables) || (publishSharedTables(name, directory) && attachSharedTables(name, tables))) return tables;
+
+        std::cerr << "Shared tables " << name << " unavailable, loading a private copy\n";
+#endif
+        return loadTables(directory);
+    }
+
+    // removes the segment name; processes that already mapped it keep their mapping
+    void unlinkSharedTables(const std::string& name) {
+#ifdef CUBE_SHARED_TABLES
+        shm_unlink(name.c_str());
+#endif
+    }
+}
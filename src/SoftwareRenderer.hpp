@@ -0,0 +1,148 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+#include <SFML/Graphics.hpp>
+
+// Rasterises the camera's sticker polygons into an RGB image on the CPU, so frames can be rendered without a
+// display or GPU. Works at supersampling times the image size and averages down, standing in for the window's
+// antialiasing. Shapes are drawn as the camera builds them: convex, untransformed, outline drawn inwards.
+class SoftwareRenderer {
+    int m_width{};
+    int m_height{};
+    int m_supersampling{};
+
+    std::vector<sf::Color> m_samples{}; // (width * supersampling) x (height * supersampling)
+
+public:
+    SoftwareRenderer(int width, int height, int supersampling = 2) :
+        m_width(width), m_height(height), m_supersampling(supersampling),
+        m_samples(static_cast<size_t>(width) * supersampling * height * supersampling) {}
+
+    int getWidth() const {
+        return m_width;
+    }
+
+    int getHeight() const {
+        return m_height;
+    }
+
+    void clear(sf::Color color = sf::Color::Black) {
+        std::fill(m_samples.begin(), m_samples.end(), color);
+    }
+
+    void draw(const sf::ConvexShape& shape) {
+        const size_t pointCount{ shape.getPointCount() };
+        if (pointCount < 3) return;
+
+        const float scale{ static_cast<float>(m_supersampling) };
+        std::vector<sf::Vector2f> points{};
+        float area{ 0.f };
+
+        for (size_t i = 0; i < pointCount; i++) {
+            points.push_back(shape.getPoint(i) * scale);
+        }
+
+        for (size_t i = 0; i < pointCount; i++) {
+            const sf::Vector2f& a{ points[i] };
+            const sf::Vector2f& b{ points[(i + 1) % pointCount] };
+            area += a.x * b.y - b.x * a.y;
+        }
+
+        if (area == 0.f) return;
+
+        // each edge as a line a * x + b * y + c, scaled so it gives the distance inside that edge
+        struct Edge { float a, b, c; };
+        std::vector<Edge> edges{};
+
+        for (size_t i = 0; i < pointCount; i++) {
+            const sf::Vector2f& from{ points[i] };
+            const sf::Vector2f& to{ points[(i + 1) % pointCount] };
+            const sf::Vector2f direction{ to - from };
+
+            const float length{ std::sqrt(direction.x * direction.x + direction.y * direction.y) };
+            if (length == 0.f) continue;
+
+            const float sign{ area > 0.f ? 1.f : -1.f };
+            const float a{ -direction.y / length * sign };
+            const float b{ direction.x / length * sign };
+            edges.push_back({ a, b, -(a * from.x + b * from.y) });
+        }
+
+        float minX{ points[0].x }, maxX{ points[0].x }, minY{ points[0].y }, maxY{ points[0].y };
+        for (const auto& point : points) {
+            minX = std::min(minX, point.x);
+            maxX = std::max(maxX, point.x);
+            minY = std::min(minY, point.y);
+            maxY = std::max(maxY, point.y);
+        }
+
+        const int columns{ m_width * m_supersampling };
+        const int rows{ m_height * m_supersampling };
+
+        const int startX{ std::max(0, static_cast<int>(std::floor(minX))) };
+        const int endX{ std::min(columns - 1, static_cast<int>(std::ceil(maxX))) };
+        const int startY{ std::max(0, static_cast<int>(std::floor(minY))) };
+        const int endY{ std::min(rows - 1, static_cast<int>(std::ceil(maxY))) };
+
+        const float outline{ -shape.getOutlineThickness() * scale }; // negative thickness is drawn inside the shape
+        const sf::Color fillColor{ shape.getFillColor() };
+        const sf::Color outlineColor{ shape.getOutlineColor() };
+
+        for (int y = startY; y <= endY; y++) {
+            sf::Color* row{ &m_samples[static_cast<size_t>(y) * columns] };
+            const float sampleY{ y + 0.5f };
+
+            for (int x = startX; x <= endX; x++) {
+                const float sampleX{ x + 0.5f };
+                float inside{ 1e9f }; // distance to the nearest edge
+
+                for (const Edge& edge : edges) {
+                    inside = std::min(inside, edge.a * sampleX + edge.b * sampleY + edge.c);
+                }
+
+                if (inside < 0.f) continue;
+                row[x] = inside < outline ? outlineColor : fillColor;
+            }
+        }
+    }
+
+    // the image as packed 8 bit RGB, top row first
+    void resolve(std::vector<std::uint8_t>& rgb) const {
+        const int columns{ m_width * m_supersampling };
+        const int count{ m_supersampling * m_supersampling };
+
+        rgb.resize(static_cast<size_t>(m_width) * m_height * 3);
+
+        for (int y = 0; y < m_height; y++) {
+            for (int x = 0; x < m_width; x++) {
+                int r{ 0 }, g{ 0 }, b{ 0 };
+
+                for (int sy = 0; sy < m_supersampling; sy++) {
+                    const sf::Color* sample{ &m_samples[static_cast<size_t>(y * m_supersampling + sy) * columns + x * m_supersampling] };
+
+                    for (int sx = 0; sx < m_supersampling; sx++) {
+                        r += sample[sx].r;
+                        g += sample[sx].g;
+                        b += sample[sx].b;
+                    }
+                }
+
+                std::uint8_t* pixel{ &rgb[(static_cast<size_t>(y) * m_width + x) * 3] };
+                pixel[0] = static_cast<std::uint8_t>((r + count / 2) / count);
+                pixel[1] = static_cast<std::uint8_t>((g + count / 2) / count);
+                pixel[2] = static_cast<std::uint8_t>((b + count / 2) / count);
+            }
+        }
+    }
+
+    // binary PPM (P6) of an image from resolve()
+    static void writePPM(std::ostream& out, const std::vector<std::uint8_t>& rgb, int width, int height) {
+        out << "P6\n" << width << ' ' << height << "\n255\n";
+        out.write(reinterpret_cast<const char*>(rgb.data()), static_cast<std::streamsize>(rgb.size()));
+    }
+};
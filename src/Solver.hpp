@@ -9,6 +9,14 @@
 #include <map>
 #include <stack>
 #include <functional>
+#include <type_traits>
+#include <memory>
+#include <optional>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
 
 #include <algorithm>
 #include <filesystem>
@@ -18,6 +26,12 @@
 
 #include "RenderCube.hpp"
 #include "Cube.hpp"
+#include "FaceletCube.hpp"
+#include "TableMemory.hpp"
+#include "BoundedQueue.hpp"
+#include "TranspositionTable.hpp"
+#include "EndgameTable.hpp"
+#include "Trace.hpp"
 
 namespace Solver {
     constexpr std::array<std::string_view, 8> corners{
@@ -90,10 +104,14 @@ namespace Solver {
         {2, 0}
     } };
 
-    std::vector<int> loadTable(const std::string& filename, int length) {
+    // a missing or short file leaves the rest as zeros and clears *complete if given
+    std::vector<int> loadTable(const std::string& filename, int length, bool* complete = nullptr) {
+        TRACE_SCOPE("loadTable");
+
         std::vector<int> table(length);
         std::ifstream in(filename.c_str(), std::ios::binary);
         in.read(reinterpret_cast<char*>(table.data()), table.size() * sizeof(table[0]));
+        if (!in && complete) *complete = false;
         in.close();
 
         return table;
@@ -106,6 +124,340 @@ namespace Solver {
         {1, 0}
     } };
 
+    constexpr int faceletIndex(char face, std::pair<int, int> position) {
+        int f{ 0 };
+        while ("FRBLUD"[f] != face) f++;
+
+        return f * 9 + position.first * 3 + position.second;
+    }
+
+    // FaceletCube index of every sticker of the corner and edge positions, in the order of corners / edges
+    constexpr std::array<std::array<int, 3>, 8> cornerFacelets{ [] {
+        std::array<std::array<int, 3>, 8> result{};
+
+        for (int i = 0; i < 8; i++) {
+            for (int j = 0; j < 3; j++) {
+                result[i][j] = faceletIndex(corners[i][j * 2], cornerPositions[corners[i][j * 2 + 1] - '0']);
+            }
+        }
+
+        return result;
+        }() };
+
+    constexpr std::array<std::array<int, 2>, 12> edgeFacelets{ [] {
+        std::array<std::array<int, 2>, 12> result{};
+
+        for (int i = 0; i < 12; i++) {
+            for (int j = 0; j < 2; j++) {
+                result[i][j] = faceletIndex(edges[i][j * 2], edgePositions[edges[i][j * 2 + 1] - '0']);
+            }
+        }
+
+        return result;
+        }() };
+
+    // cube as the permutation and orientation of its pieces: position i holds corner cp[i] twisted by co[i]
+    // (the slot of the U/D sticker, as in getCornerOrientation) and edge ep[i] flipped by eo[i] (as in getEdgeOrientation)
+    struct CubieCube {
+        std::array<std::uint8_t, 8> cp{ 0, 1, 2, 3, 4, 5, 6, 7 };
+        std::array<std::uint8_t, 8> co{};
+        std::array<std::uint8_t, 12> ep{ 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11 };
+        std::array<std::uint8_t, 12> eo{};
+
+        FaceletCube toFaceletCube() const {
+            FaceletCube cube{};
+
+            for (int i = 0; i < 8; i++) {
+                for (int j = 0; j < 3; j++) {
+                    cube.facelets[cornerFacelets[i][(j + co[i]) % 3]] = cornerFacelets[cp[i]][j] / 9;
+                }
+            }
+
+            for (int i = 0; i < 12; i++) {
+                for (int j = 0; j < 2; j++) {
+                    cube.facelets[edgeFacelets[i][(j + eo[i]) % 2]] = edgeFacelets[ep[i]][j] / 9;
+                }
+            }
+
+            return cube;
+        }
+
+        // the cube reached by applying the inverse of any sequence that reaches this one
+        CubieCube inverse() const {
+            CubieCube result{};
+
+            for (int i = 0; i < 8; i++) {
+                result.cp[cp[i]] = i;
+                result.co[cp[i]] = (3 - co[i]) % 3;
+            }
+
+            for (int i = 0; i < 12; i++) {
+                result.ep[ep[i]] = i;
+                result.eo[ep[i]] = eo[i];
+            }
+
+            return result;
+        }
+    };
+
+    enum Validity {
+        VALID,
+        INVALID_COLOR,
+        WRONG_COLOR_COUNT,
+        WRONG_CENTERS,
+        INVALID_CORNER,
+        DUPLICATE_CORNER,
+        INVALID_EDGE,
+        DUPLICATE_EDGE,
+        TWISTED_CORNER,
+        FLIPPED_EDGE,
+        PARITY_ERROR
+    };
+
+    std::string_view describeValidity(Validity validity) {
+        switch (validity) {
+        case VALID: return "valid";
+        case INVALID_COLOR: return "sticker with an unknown colour";
+        case WRONG_COLOR_COUNT: return "a colour does not appear exactly 9 times";
+        case WRONG_CENTERS: return "centers are not in their solved positions";
+        case INVALID_CORNER: return "corner with a colour combination that does not exist";
+        case DUPLICATE_CORNER: return "same corner appears twice";
+        case INVALID_EDGE: return "edge with a colour combination that does not exist";
+        case DUPLICATE_EDGE: return "same edge appears twice";
+        case TWISTED_CORNER: return "a single corner is twisted (corner orientations do not sum to 0 mod 3)";
+        case FLIPPED_EDGE: return "a single edge is flipped (edge orientations do not sum to 0 mod 2)";
+        case PARITY_ERROR: return "two pieces are swapped (corner and edge permutation parity differ)";
+        }
+
+        return "unknown";
+    }
+
+    // recovers the pieces of a facelet state and checks it can be reached from the solved cube,
+    // returning the first problem found so no search is started on an impossible cube
+    Validity validate(const FaceletCube& cube, CubieCube* cubies = nullptr) {
+        // sticker colours read clockwise from the U/D sticker (corners) or in edges order (edges) -> piece
+        static const auto pieceByColors{ [] {
+            std::pair<std::array<int, 216>, std::array<int, 36>> result{};
+            result.first.fill(-1);
+            result.second.fill(-1);
+
+            for (int c = 0; c < 8; c++) {
+                const auto& f{ cornerFacelets[c] };
+                result.first[(f[0] / 9) * 36 + (f[1] / 9) * 6 + f[2] / 9] = c;
+            }
+
+            for (int e = 0; e < 12; e++) {
+                const auto& f{ edgeFacelets[e] };
+                result.second[(f[0] / 9) * 6 + f[1] / 9] = e * 2;
+                result.second[(f[1] / 9) * 6 + f[0] / 9] = e * 2 + 1;
+            }
+
+            return result;
+            }() };
+
+        std::array<int, 6> colorCount{};
+
+        for (int i = 0; i < FaceletCube::numFacelets; i++) {
+            if (cube.facelets[i] >= 6) return INVALID_COLOR;
+            colorCount[cube.facelets[i]]++;
+        }
+
+        for (int face = 0; face < 6; face++) {
+            if (colorCount[face] != 9) return WRONG_COLOR_COUNT;
+        }
+
+        for (int face = 0; face < 6; face++) {
+            if (cube.facelets[face * 9 + 4] != face) return WRONG_CENTERS;
+        }
+
+        CubieCube result{};
+        int seenCorners{ 0 };
+        int seenEdges{ 0 };
+        int twist{ 0 };
+        int flip{ 0 };
+
+        for (int i = 0; i < 8; i++) {
+            std::array<int, 3> colors{};
+            for (int j = 0; j < 3; j++) colors[j] = cube.facelets[cornerFacelets[i][j]];
+
+            int orientation{ 0 };
+            while (orientation < 3 && colors[orientation] != 4 && colors[orientation] != 5) orientation++;
+            if (orientation == 3) return INVALID_CORNER;
+
+            const int corner{ pieceByColors.first[colors[orientation] * 36 + colors[(orientation + 1) % 3] * 6 + colors[(orientation + 2) % 3]] };
+            if (corner == -1) return INVALID_CORNER;
+            if (seenCorners & (1 << corner)) return DUPLICATE_CORNER;
+
+            seenCorners |= 1 << corner;
+            result.cp[i] = corner;
+            result.co[i] = orientation;
+            twist += orientation;
+        }
+
+        for (int i = 0; i < 12; i++) {
+            const int piece{ pieceByColors.second[cube.facelets[edgeFacelets[i][0]] * 6 + cube.facelets[edgeFacelets[i][1]]] };
+            if (piece == -1) return INVALID_EDGE;
+            if (seenEdges & (1 << (piece / 2))) return DUPLICATE_EDGE;
+
+            seenEdges |= 1 << (piece / 2);
+            result.ep[i] = piece / 2;
+            result.eo[i] = piece % 2;
+            flip += piece % 2;
+        }
+
+        if (twist % 3 != 0) return TWISTED_CORNER;
+        if (flip % 2 != 0) return FLIPPED_EDGE;
+
+        int parity{ 0 };
+
+        for (int i = 0; i < 8; i++) {
+            for (int j = 0; j < i; j++) {
+                if (result.cp[j] > result.cp[i]) parity ^= 1;
+            }
+        }
+
+        for (int i = 0; i < 12; i++) {
+            for (int j = 0; j < i; j++) {
+                if (result.ep[j] > result.ep[i]) parity ^= 1;
+            }
+        }
+
+        if (parity != 0) return PARITY_ERROR;
+
+        if (cubies) *cubies = result;
+        return VALID;
+    }
+
+    Validity validate(const FaceColors& colors) {
+        return validate(FaceletCube::fromFaceColors(colors));
+    }
+
+    // every search start coordinate of a cube, as the six get... functions below compute them;
+    // the phase 2 edge coordinates are -1 unless the cube is already in phase 2
+    struct Coordinates {
+        int cornerOrientation;
+        int edgeOrientation;
+        int udSlice;
+        int cornerPermutation;
+        int edgePermutation;
+        int udSlicePermutation;
+    };
+
+    // number of set bits in a piece mask (at most 12 bits)
+    constexpr int countBits(unsigned mask) {
+        mask = mask - ((mask >> 1) & 0x555);
+        mask = (mask & 0x333) + ((mask >> 2) & 0x333);
+        return static_cast<int>(((mask + (mask >> 4)) & 0x0f0f) % 255);
+    }
+
+    // all coordinates in one pass over the stickers: every piece is read once and looked up by its colours, which
+    // gives its identity and orientation together; the cube must be valid, otherwise the result is meaningless
+    Coordinates getCoordinates(const FaceletCube& cube) {
+        // colours a << 6 | b << 3 | c of a corner's stickers -> piece | orientation << 4, and
+        // colours a << 3 | b of an edge's stickers -> piece | flip << 4; unknown colours read as piece 0
+        static const auto pieceByColors{ [] {
+            std::pair<std::array<std::uint8_t, 512>, std::array<std::uint8_t, 64>> result{};
+
+            for (int c = 0; c < 8; c++) {
+                const auto& f{ cornerFacelets[c] };
+
+                for (int o = 0; o < 3; o++) {
+                    std::array<int, 3> colors{};
+                    for (int j = 0; j < 3; j++) colors[(j + o) % 3] = f[j] / 9;
+
+                    result.first[colors[0] << 6 | colors[1] << 3 | colors[2]] = static_cast<std::uint8_t>(c | o << 4);
+                }
+            }
+
+            for (int e = 0; e < 12; e++) {
+                const auto& f{ edgeFacelets[e] };
+                result.second[(f[0] / 9) << 3 | f[1] / 9] = static_cast<std::uint8_t>(e);
+                result.second[(f[1] / 9) << 3 | f[0] / 9] = static_cast<std::uint8_t>(e | 1 << 4);
+            }
+
+            return result;
+            }() };
+
+        const auto& stickers{ cube.facelets };
+        Coordinates result{ 0, 0, 0, 0, 0, 0 };
+        unsigned seen{ 0 };
+
+        for (int i = 0; i < 8; i++) {
+            const auto& f{ cornerFacelets[i] };
+            const int entry{ pieceByColors.first[(stickers[f[0]] & 7) << 6 | (stickers[f[1]] & 7) << 3 | (stickers[f[2]] & 7)] };
+            const int piece{ entry & 15 };
+
+            if (i < 7) result.cornerOrientation = result.cornerOrientation * 3 + (entry >> 4); // DRB not considered
+            result.cornerPermutation += countBits(seen >> (piece + 1)) * factorial[i]; // earlier pieces numbered higher
+            seen |= 1u << piece;
+        }
+
+        // nCr[i][r - 1], with 0 for r = 0: the udSlice weight of a non slice edge at i after r slice edges, so the
+        // piece loop has no data dependent branch
+        static constexpr auto sliceWeights{ [] {
+            std::array<std::array<int, 5>, 12> result{};
+
+            for (int i = 0; i < 12; i++) {
+                for (int r = 1; r < 5; r++) result[i][r] = nCr[i][r - 1];
+            }
+
+            return result;
+            }() };
+
+        std::array<int, 12> edgePieces{};
+        int sliceEdges{ 0 };
+
+        for (int i = 0; i < 12; i++) {
+            const auto& f{ edgeFacelets[i] };
+            const int entry{ pieceByColors.second[(stickers[f[0]] & 7) << 3 | (stickers[f[1]] & 7)] };
+            const int isSlice{ (entry >> 3) & 1 }; // pieces 8 to 11
+            edgePieces[i] = entry & 15;
+
+            if (i < 11) result.edgeOrientation = result.edgeOrientation * 2 + (entry >> 4); // BR not considered
+
+            result.udSlice += sliceWeights[i][sliceEdges] * (1 - isSlice);
+            sliceEdges += isSlice;
+        }
+
+        if (result.cornerOrientation != 0 || result.edgeOrientation != 0 || result.udSlice != 0) {
+            result.edgePermutation = -1;
+            result.udSlicePermutation = -1;
+            return result;
+        }
+
+        seen = 0;
+        for (int i = 0; i < 8; i++) {
+            result.edgePermutation += countBits(seen >> (edgePieces[i] + 1)) * factorial[i];
+            seen |= 1u << edgePieces[i];
+        }
+
+        seen = 0;
+        for (int i = 0; i < 4; i++) {
+            result.udSlicePermutation += countBits(seen >> (edgePieces[i + 8] - 8 + 1)) * factorial[i];
+            seen |= 1u << (edgePieces[i + 8] - 8);
+        }
+
+        return result;
+    }
+
+    // coordinates of count cubes, split into contiguous chunks over the given number of threads; each thread converts
+    // its cubes one at a time with the scalar, branch-free pass above, nothing is vectorised across cubes
+    void getCoordinates(const FaceletCube* cubes, size_t count, Coordinates* coordinates, int threads = 1) {
+        const auto convert{ [=](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++) coordinates[i] = getCoordinates(cubes[i]);
+            } };
+
+        const size_t chunks{ std::min<size_t>(std::max(threads, 1), count / 4096 + 1) }; // small batches are not worth a thread
+        std::vector<std::thread> workers{};
+
+        for (size_t chunk = 1; chunk < chunks; chunk++) {
+            workers.emplace_back(convert, count * chunk / chunks, count * (chunk + 1) / chunks);
+        }
+
+        convert(0, count / chunks);
+        for (auto& worker : workers) worker.join();
+    }
+
 
     int getCornerOrientation(const FaceColors& colors) {
         int ans{ 0 };
@@ -184,12 +536,10 @@ namespace Solver {
         std::vector<bool> visited(length, false);
         int visitedCount{ 0 };
 
-        Cube cube{ 0.f };
-
-        std::vector<std::pair<int, FaceColors>> v{ {0, cube.faceColors} };
+        std::vector<std::pair<int, FaceletCube>> v{ {0, FaceletCube{}} };
 
         while (!v.empty()) {
-            auto [coord, colors] = v.back();
+            auto [coord, state] = v.back();
             v.pop_back(); // dfs
 
             if (coord < 0 || coord >= length) {
@@ -205,15 +555,13 @@ namespace Solver {
 
             for (int i = 0; i < 6; i++) {
                 for (int j = 0; j < 3; j++) {
-                    cube.faceColors = colors;
-                    for (int k = 0; k < j + 1; k++) {
-                        moveCube(cube, "FRBLUD"[i]);
-                    }
+                    FaceletCube next{ state };
+                    next.move(i * 3 + j);
 
-                    const int newCoord{ coordFunc(cube.faceColors) };
+                    const int newCoord{ coordFunc(next.toFaceColors()) };
                     table[coord * 18 + (i * 3 + j)] = newCoord;
 
-                    v.emplace_back(newCoord, cube.faceColors);
+                    v.emplace_back(newCoord, next);
                 }
             }
         }
@@ -273,17 +621,539 @@ namespace Solver {
         int lastMove;
     };
 
-    std::vector<int> idaPhase1Search(const Cube& cube) {
-        auto cornerTable = loadTable("cornerOrientation1.bin", 2187 * 18);
-        auto edgeTable = loadTable("edgeOrientation1.bin", 2048 * 18);
-        auto udSliceTable = loadTable("UDSliceCoordinate1.bin", 495 * 18);
-        auto pruneTable = loadTable("pruningTable1.bin", 2187 * 2048);
+    // flat table indexed by coordinate, either owning its memory or borrowing memory kept alive by storage
+    // (a segment shared between processes)
+    template <typename T>
+    class Table {
+    protected:
+        std::shared_ptr<const void> m_storage{};
+        const T* m_data{ nullptr };
+        size_t m_size{ 0 };
+
+    public:
+        using value_type = T;
+        static constexpr int entriesPerCoord{ 1 };
+
+        Table() = default;
+        Table(std::shared_ptr<const void> storage, const T* data, size_t length) :
+            m_storage(std::move(storage)), m_data(data), m_size(length) {}
+
+        // narrows a table as stored on disk
+        static Table fromCoordMajor(const std::vector<int>& values, size_t length) {
+            std::shared_ptr<void> memory{ TableMemory::allocate(length * sizeof(T)) };
+            T* data{ static_cast<T*>(memory.get()) };
+
+            for (size_t i = 0; i < length; i++) {
+                data[i] = static_cast<T>(values[i]);
+            }
+
+            return Table{ std::move(memory), data, length };
+        }
+
+        const T& operator[](size_t i) const {
+            return m_data[i];
+        }
+
+        const T* data() const {
+            return m_data;
+        }
+
+        size_t size() const {
+            return m_size;
+        }
+    };
+
+    // move table with 16 bit entries (every coordinate is below 40320), coordinate major so the moves from one
+    // coordinate share a cache line
+    template <int Moves>
+    class MoveTable : public Table<std::uint16_t> {
+    public:
+        static constexpr int entriesPerCoord{ Moves };
+
+        MoveTable() = default;
+        MoveTable(std::shared_ptr<const void> storage, const std::uint16_t* data, size_t length) :
+            Table{ std::move(storage), data, length * Moves } {}
+
+        // narrows a table as stored on disk, which has 32 bit entries
+        static MoveTable fromCoordMajor(const std::vector<int>& values, size_t length) {
+            std::shared_ptr<void> memory{ TableMemory::allocate(length * Moves * sizeof(std::uint16_t)) };
+            auto* data{ static_cast<std::uint16_t*>(memory.get()) };
+
+            for (size_t i = 0; i < length * Moves; i++) {
+                data[i] = static_cast<std::uint16_t>(values[i]);
+            }
+
+            return MoveTable{ std::move(memory), data, length };
+        }
+
+        int operator()(int coord, int move) const {
+            return m_data[coord * Moves + move];
+        }
+    };
+
+    // how much memory the phase 1 pruning takes; the phase 2 tables are the same in every tier
+    enum TableTier {
+        TINY,     // no pruningTable1.bin: phase 1 is bounded by each coordinate's own distance, and no endgame table
+        STANDARD, // corner x edge orientation distances from pruningTable1.bin
+        LARGE,    // also orientation x UD slice distances, built from the move tables when loading
+        EXACT     // standard plus pruningTable1Exact.bin from generatePhase1ExactTable: phase 1 needs no search at all
+    };
+
+    // every move and pruning table the searches need, loaded once and shared read-only between solves
+    struct Tables {
+        TableTier tier{ STANDARD };
+
+        MoveTable<18> cornerOrientation1;
+        MoveTable<18> edgeOrientation1;
+        MoveTable<18> udSlice1;
+        Table<std::uint8_t> prune1;
+
+        Table<std::uint8_t> prune1Corner;  // TINY: by corner orientation alone
+        Table<std::uint8_t> prune1Edge;    // TINY: by edge orientation alone
+        Table<std::uint8_t> prune1UDSlice; // TINY: by UD slice alone
+        Table<std::uint8_t> prune1CornerUDSlice; // LARGE: corner orientation * 495 + UD slice
+        Table<std::uint8_t> prune1EdgeUDSlice;   // LARGE: edge orientation * 495 + UD slice
+        Table<std::uint8_t> prune1Exact;         // EXACT: distance mod 3 of every phase 1 state, four to a byte
+
+        MoveTable<10> cornerPermutation2;
+        MoveTable<10> edgePermutation2;
+        MoveTable<10> udPermutation2;
+        Table<std::uint8_t> prune2Corner;
+        Table<std::uint8_t> prune2Edge;
+        EndgameTable endgame2; // from phase2Endgame.bin if it was generated, in every tier
+
+        bool complete{ true }; // false if a table file was missing or short, so the searches cannot be trusted
+    };
+
+    constexpr int numTables{ 9 };
+
+    // calls func(table, filename, number of coordinates) for every table, in a fixed order
+    template <typename TablesType, typename Func>
+    void forEachTable(TablesType& tables, Func&& func) {
+        func(tables.cornerOrientation1, "cornerOrientation1.bin", 2187);
+        func(tables.edgeOrientation1, "edgeOrientation1.bin", 2048);
+        func(tables.udSlice1, "UDSliceCoordinate1.bin", 495);
+        func(tables.prune1, "pruningTable1.bin", 2187 * 2048);
+        func(tables.cornerPermutation2, "cornerPermutation2.bin", factorial[8]);
+        func(tables.edgePermutation2, "edgePermutation2.bin", factorial[8]);
+        func(tables.udPermutation2, "UDPermutation2.bin", 24);
+        func(tables.prune2Corner, "pruningTable2-1.bin", factorial[8]);
+        func(tables.prune2Edge, "pruningTable2-2.bin", factorial[8]);
+    }
+
+    // table files in directory that are missing or not the size loadTables expects, for the tables the tier reads
+    std::vector<std::string> missingTables(const std::filesystem::path& directory, TableTier tier = STANDARD) {
+        Tables expected{};
+        std::vector<std::string> missing{};
+
+        forEachTable(expected, [&](auto& table, const char* filename, int length) {
+            using TableType = std::decay_t<decltype(table)>;
+            const std::uintmax_t bytes{ static_cast<std::uintmax_t>(length) * TableType::entriesPerCoord * sizeof(int) };
+            if (tier == TINY && static_cast<const void*>(&table) == &expected.prune1) return;
+
+            std::error_code error{};
+            if (std::filesystem::file_size(directory / filename, error) != bytes || error) missing.push_back(filename);
+            });
+
+        return missing;
+    }
+
+    // moves from the goal (index 0) of every index below size, by breadth first search with next(index, move)
+    // over the 18 phase 1 moves
+    template <typename Next>
+    Table<std::uint8_t> distanceTable(size_t size, Next&& next) {
+        std::shared_ptr<void> memory{ TableMemory::allocate(size) };
+        auto* distance{ static_cast<std::uint8_t*>(memory.get()) };
+
+        std::fill(distance, distance + size, std::uint8_t{ 0xff });
+        distance[0] = 0;
+
+        for (int depth = 0; ; depth++) {
+            bool reached{ false };
+
+            for (size_t index = 0; index < size; index++) {
+                if (distance[index] != depth) continue;
+
+                for (int move = 0; move < 18; move++) {
+                    const size_t neighbour{ static_cast<size_t>(next(index, move)) };
+                    if (distance[neighbour] != 0xff) continue;
+
+                    distance[neighbour] = static_cast<std::uint8_t>(depth + 1);
+                    reached = true;
+                }
+            }
+
+            if (!reached) break;
+        }
+
+        return Table<std::uint8_t>{ std::move(memory), distance, size };
+    }
+
+    constexpr size_t phase1States{ size_t{ 2187 } * 2048 * 495 };
+
+    // phase 2 state as a key of the endgame table
+    constexpr std::uint64_t phase2Index(int corner, int edge, int udSlice) {
+        return (static_cast<std::uint64_t>(corner) * 40320 + edge) * 24 + udSlice;
+    }
+
+    // states within this many phase 2 moves of solved go into the endgame table
+    constexpr int endgameDepth{ 7 };
+
+    // the endgame table of endgameDepth once loaded: 883k states within 7 moves in a hash table at most half full
+    constexpr size_t endgameTableBytes{ (size_t{ 1 } << 21) * sizeof(std::uint64_t) };
+
+    // position of a phase 1 state in the exact table
+    constexpr size_t phase1Index(int corner, int edge, int udSlice) {
+        return (static_cast<size_t>(corner) * 2048 + edge) * 495 + udSlice;
+    }
+
+    // Exact phase 1 distances of every state, mod 3 in two bits and four states to a byte, which is enough: the
+    // neighbours of a state are one closer, as far or one further, and the three differ mod 3. Breadth first on
+    // the given number of threads, expanding the states at the current depth while few are reached, then checking
+    // the states not reached yet for a neighbour at the current depth. Writes pruningTable1Exact.bin (529 MB) in
+    // about two and a half minutes on one core.
+    void generatePhase1ExactTable(int threads = static_cast<int>(std::thread::hardware_concurrency())) {
+        const auto cornerTable{ loadTable("cornerOrientation1.bin", 2187 * 18) };
+        const auto edgeTable{ loadTable("edgeOrientation1.bin", 2048 * 18) };
+        const auto udSliceTable{ loadTable("UDSliceCoordinate1.bin", 495 * 18) };
+
+        static_assert(sizeof(std::atomic<std::uint8_t>) == 1, "the table is written out byte for byte");
+        const size_t bytes{ phase1States / 4 };
+        std::unique_ptr<std::atomic<std::uint8_t>[]> table{ new std::atomic<std::uint8_t>[bytes] };
+
+        for (size_t i = 0; i < bytes; i++) {
+            table[i].store(0xff, std::memory_order_relaxed); // 3: not reached
+        }
+
+        const auto get{ [&](size_t index) {
+            return (table[index >> 2].load(std::memory_order_relaxed) >> (index & 3) * 2) & 3;
+            } };
+
+        // true if the state was not reached before
+        const auto set{ [&](size_t index, int distance) {
+            const int shift{ static_cast<int>(index & 3) * 2 };
+            const std::uint8_t old{ table[index >> 2].fetch_and(static_cast<std::uint8_t>(~((3 ^ distance) << shift)), std::memory_order_relaxed) };
+            return ((old >> shift) & 3) == 3;
+            } };
+
+        set(phase1Index(0, 0, 0), 0);
+        size_t reached{ 1 };
+        size_t frontier{ 1 };
+
+        for (int depth = 0; frontier > 0; depth++) {
+            const int current{ depth % 3 };
+            const int next{ (depth + 1) % 3 };
+            const bool backward{ frontier > (phase1States - reached) / 8 };
+
+            std::atomic<int> nextCorner{ 0 };
+            std::atomic<size_t> found{ 0 };
+
+            const auto work{ [&] {
+                size_t count{ 0 };
+
+                for (int corner = nextCorner++; corner < 2187; corner = nextCorner++) {
+                    for (int edge = 0; edge < 2048; edge++) {
+                        std::array<size_t, 18> bases{};
+                        for (int move = 0; move < 18; move++) {
+                            bases[move] = phase1Index(cornerTable[corner * 18 + move], edgeTable[edge * 18 + move], 0);
+                        }
+
+                        const size_t start{ phase1Index(corner, edge, 0) };
+
+                        for (int udSlice = 0; udSlice < 495; udSlice++) {
+                            const int distance{ static_cast<int>(get(start + udSlice)) };
+                            if (distance != (backward ? 3 : current)) continue; // states at depth - 3 come here too, their neighbours are all reached
+
+                            for (int move = 0; move < 18; move++) {
+                                const size_t neighbour{ bases[move] + udSliceTable[udSlice * 18 + move] };
+
+                                if (!backward && get(neighbour) == 3 && set(neighbour, next)) {
+                                    count++;
+                                }
+                                else if (backward && get(neighbour) == current) {
+                                    set(start + udSlice, next);
+                                    count++;
+                                    break;
+                                }
+                            }
+                        }
+                    }
+                }
+
+                found += count;
+                } };
+
+            std::vector<std::thread> workers{};
+            for (int i = 1; i < threads; i++) workers.emplace_back(work);
+            work();
+            for (auto& worker : workers) worker.join();
+
+            frontier = found;
+            reached += frontier;
+            std::cout << "Depth " << depth + 1 << ": " << frontier << " states" << (backward ? " (backward)" : "") << '\n';
+        }
+
+        std::ofstream out("pruningTable1Exact.bin", std::ios::binary);
+        std::vector<char> buffer(1 << 20);
+
+        for (size_t i = 0; i < bytes; i += buffer.size()) {
+            const size_t length{ std::min(buffer.size(), bytes - i) };
+            for (size_t j = 0; j < length; j++) buffer[j] = static_cast<char>(table[i + j].load(std::memory_order_relaxed));
+            out.write(buffer.data(), length);
+        }
+    }
+
+    // bytes a tier's tables take once loaded, with the endgame table unless endgame is false
+    constexpr size_t tableBytes(TableTier tier, bool endgame = true) {
+        const size_t moveTables{ (2187 + 2048 + 495) * 18 * 2 + (40320 + 40320 + 24) * 10 * 2 };
+        const size_t phase2Pruning{ 2 * 40320 };
+        const size_t phase1Pruning{ tier == TINY ? size_t{ 2187 + 2048 + 495 } :
+            tier == STANDARD ? size_t{ 2187 * 2048 } : tier == LARGE ? size_t{ 2187 * 2048 + (2187 + 2048) * 495 } : size_t{ 2187 * 2048 } + phase1States / 4 };
+
+        return moveTables + phase2Pruning + phase1Pruning + (endgame && tier != TINY ? endgameTableBytes : 0);
+    }
+
+    // the largest tier that fits in budget bytes, or TINY if none does
+    constexpr TableTier chooseTableTier(size_t budget) {
+        if (budget >= tableBytes(EXACT)) return EXACT;
+        if (budget >= tableBytes(LARGE)) return LARGE;
+        if (budget >= tableBytes(STANDARD)) return STANDARD;
+        return TINY;
+    }
+
+    // name and size of a tier; solve-bench measures what it costs on this machine
+    std::string describeTableTier(TableTier tier) {
+        const std::string size{ " (" + std::to_string((tableBytes(tier) + 512 * 1024) / (1024 * 1024)) + " MB)" };
+
+        switch (tier) {
+        case TINY: return "tiny" + size;
+        case STANDARD: return "standard" + size;
+        case LARGE: return "large" + size;
+        case EXACT: return "exact" + size;
+        }
+
+        return "unknown";
+    }
+
+    // a table read byte for byte, or an empty one if the file does not have exactly that many bytes
+    Table<std::uint8_t> loadByteTable(const std::filesystem::path& path, size_t bytes) {
+        TRACE_SCOPE("loadTable");
+
+        std::error_code error{};
+        if (std::filesystem::file_size(path, error) != bytes || error) return {};
+
+        std::shared_ptr<void> memory{ TableMemory::allocate(bytes) };
+        auto* data{ static_cast<std::uint8_t*>(memory.get()) };
+
+        std::ifstream in(path, std::ios::binary);
+        in.read(reinterpret_cast<char*>(data), static_cast<std::streamsize>(bytes));
+        if (!in) return {};
+
+        return Table<std::uint8_t>{ std::move(memory), data, bytes };
+    }
+
+    // an empty table if the file is missing
+    EndgameTable loadEndgameTable(const std::filesystem::path& path) {
+        TRACE_SCOPE("loadTable");
+
+        std::error_code error{};
+        const std::uintmax_t bytes{ std::filesystem::file_size(path, error) };
+        if (error || bytes % sizeof(std::uint64_t) != 0) return {};
 
-        int startCorner{ getCornerOrientation(cube.faceColors) };
-        int startEdge{ getEdgeOrientation(cube.faceColors) };
-        int startUDSlice{ getUDSliceCoordinate(cube.faceColors) };
+        std::vector<std::uint64_t> entries(bytes / sizeof(std::uint64_t));
+        std::ifstream in(path, std::ios::binary);
+        in.read(reinterpret_cast<char*>(entries.data()), static_cast<std::streamsize>(bytes));
+        if (!in) return {};
 
-        int threshold{ std::max({ pruneTable[startCorner * 2048 + startEdge], 1 }) };
+        return EndgameTable{ entries };
+    }
+
+    // loads the tables a tier needs from directory; TINY does not read pruningTable1.bin or phase2Endgame.bin at
+    // all, and EXACT falls back to LARGE if pruningTable1Exact.bin has not been generated
+    Tables loadTables(const std::filesystem::path& directory = ".", TableTier tier = STANDARD) {
+        Tables tables{};
+        tables.tier = tier;
+
+        forEachTable(tables, [&](auto& table, const char* filename, int length) {
+            using TableType = std::decay_t<decltype(table)>;
+            const int entries{ length * TableType::entriesPerCoord };
+
+            if (tier == TINY && static_cast<const void*>(&table) == &tables.prune1) return;
+            table = TableType::fromCoordMajor(loadTable((directory / filename).string(), entries, &tables.complete), length);
+            });
+
+        if (tier != TINY) tables.endgame2 = loadEndgameTable(directory / "phase2Endgame.bin");
+
+        const auto& corners{ tables.cornerOrientation1 };
+        const auto& edges{ tables.edgeOrientation1 };
+        const auto& udSlices{ tables.udSlice1 };
+
+        if (tier == TINY) {
+            tables.prune1Corner = distanceTable(2187, [&](size_t corner, int move) { return corners(static_cast<int>(corner), move); });
+            tables.prune1Edge = distanceTable(2048, [&](size_t edge, int move) { return edges(static_cast<int>(edge), move); });
+            tables.prune1UDSlice = distanceTable(495, [&](size_t udSlice, int move) { return udSlices(static_cast<int>(udSlice), move); });
+        }
+
+        if (tier == EXACT) {
+            tables.prune1Exact = loadByteTable(directory / "pruningTable1Exact.bin", phase1States / 4);
+
+            if (tables.prune1Exact.size() == 0) tables.tier = LARGE; // the caller sees the tier it got
+        }
+
+        if (tables.tier == LARGE) { // exact needs them only when its table is missing
+            tables.prune1CornerUDSlice = distanceTable(2187 * 495, [&](size_t index, int move) {
+                return static_cast<size_t>(corners(static_cast<int>(index / 495), move)) * 495 + udSlices(static_cast<int>(index % 495), move);
+                });
+            tables.prune1EdgeUDSlice = distanceTable(2048 * 495, [&](size_t index, int move) {
+                return static_cast<size_t>(edges(static_cast<int>(index / 495), move)) * 495 + udSlices(static_cast<int>(index % 495), move);
+                });
+        }
+
+        return tables;
+    }
+
+    // tables from the working directory, loaded on first use
+    const Tables& getTables() {
+        static const Tables tables{ loadTables() };
+        return tables;
+    }
+
+    // lower bound on the phase 1 moves left, from whichever pruning tables the tier has
+    int phase1Bound(const Tables& tables, int corner, int edge, int udSlice) {
+        switch (tables.tier) {
+        case TINY:
+            return std::max({ tables.prune1Corner[corner], tables.prune1Edge[edge], tables.prune1UDSlice[udSlice] });
+        case LARGE:
+            return std::max({ tables.prune1[corner * 2048 + edge], tables.prune1CornerUDSlice[corner * 495 + udSlice], tables.prune1EdgeUDSlice[edge * 495 + udSlice] });
+        default: // EXACT searches by its own table, see phase1Distance
+            return tables.prune1[corner * 2048 + edge];
+        }
+    }
+
+    // distance of a phase 1 state mod 3 (EXACT only)
+    int phase1DistanceMod3(const Tables& tables, int corner, int edge, int udSlice) {
+        const size_t index{ phase1Index(corner, edge, udSlice) };
+        return (tables.prune1Exact[index >> 2] >> (index & 3) * 2) & 3;
+    }
+
+    // the distance of a neighbour of a state at the given distance (EXACT only)
+    int phase1NeighbourDistance(const Tables& tables, int distance, int corner, int edge, int udSlice) {
+        const int step{ (phase1DistanceMod3(tables, corner, edge, udSlice) - distance % 3 + 3) % 3 }; // 0, 1 or -1 mod 3
+        return distance + (step + 1) % 3 - 1;
+    }
+
+    // an optimal phase 1 solution taking the first move that gets one closer at every step, without any search
+    // (EXACT only)
+    std::vector<int> phase1Walk(const Tables& tables, int corner, int edge, int udSlice) {
+        std::vector<int> moves{};
+        int distance{ phase1DistanceMod3(tables, corner, edge, udSlice) };
+
+        while (corner != 0 || edge != 0 || udSlice != 0) {
+            const int closer{ (distance + 2) % 3 };
+
+            for (int move = 0; move < 18; move++) {
+                const int newCorner{ tables.cornerOrientation1(corner, move) };
+                const int newEdge{ tables.edgeOrientation1(edge, move) };
+                const int newUDSlice{ tables.udSlice1(udSlice, move) };
+
+                if (phase1DistanceMod3(tables, newCorner, newEdge, newUDSlice) == closer) {
+                    moves.push_back(move);
+                    corner = newCorner;
+                    edge = newEdge;
+                    udSlice = newUDSlice;
+                    distance = closer;
+                    break;
+                }
+            }
+        }
+
+        return moves;
+    }
+
+    // exact phase 1 distance, as the length of the walk (EXACT only)
+    int phase1Distance(const Tables& tables, int corner, int edge, int udSlice) {
+        return static_cast<int>(phase1Walk(tables, corner, edge, udSlice).size());
+    }
+
+    using SolveClock = std::chrono::steady_clock;
+
+    // lets another thread give up a solve that is in progress
+    class CancellationToken {
+        std::atomic<bool> m_cancelled{ false };
+        const CancellationToken* m_parent{ nullptr }; // cancelling the parent cancels this token too
+
+    public:
+        explicit CancellationToken(const CancellationToken* parent = nullptr) : m_parent(parent) {}
+
+        void cancel() {
+            m_cancelled.store(true, std::memory_order_relaxed);
+        }
+
+        bool isCancelled() const {
+            return m_cancelled.load(std::memory_order_relaxed) || (m_parent && m_parent->isCancelled());
+        }
+    };
+
+    // when a search has to give up, and how many nodes it visited; the clock and the token are only
+    // looked at every checkInterval nodes so the check costs next to nothing per node
+    struct SearchControl {
+        static constexpr long long checkInterval{ 4096 };
+
+        const CancellationToken* token{ nullptr };
+        std::optional<SolveClock::time_point> deadline{};
+        TranspositionTable* transpositions{ nullptr }; // bounds learned by earlier iterations and solves, if any
+        long long nodes{ 0 };
+        bool stopped{ false };
+
+        bool check() {
+            if (!stopped) stopped = (token && token->isCancelled()) || (deadline && SolveClock::now() >= *deadline);
+            return stopped;
+        }
+
+        // counts a node, true once the search should unwind
+        bool visit() {
+            return (++nodes & (checkInterval - 1)) == 0 ? check() : stopped;
+        }
+    };
+
+    constexpr int searchStopped{ -2 }; // returned by the search lambdas once the control says stop
+
+    // nodes this close to the threshold have subtrees cheaper to search than a table lookup
+    constexpr int transpositionMinDepth{ 6 };
+
+    // transposition table keys: the coordinates and the last move, which decides the moves allowed next
+    constexpr std::uint64_t phase1Key(int corner, int edge, int udSlice, int lastMove) {
+        return ((static_cast<std::uint64_t>(corner * 2048 + edge) * 495 + udSlice) * 19 + (lastMove + 1)) * 2;
+    }
+
+    constexpr std::uint64_t phase2Key(int corner, int edge, int udSlice, int lastMove) {
+        return ((static_cast<std::uint64_t>(corner) * 40320 + edge) * 24 + udSlice) * 11 * 2 + (lastMove + 1) * 2 + 1;
+    }
+
+    // nothing if the search was stopped first
+    std::optional<std::vector<int>> idaPhase1Search(const Cube& cube, const Tables& tables = getTables(), SearchControl* control = nullptr) {
+        TRACE_SCOPE("idaPhase1Search");
+
+        SearchControl unlimited{};
+        SearchControl& limits{ control ? *control : unlimited };
+        if (limits.check()) return std::nullopt;
+
+        const auto& cornerTable{ tables.cornerOrientation1 };
+        const auto& edgeTable{ tables.edgeOrientation1 };
+        const auto& udSliceTable{ tables.udSlice1 };
+
+        const Coordinates start{ getCoordinates(FaceletCube::fromFaceColors(cube.faceColors)) };
+        int startCorner{ start.cornerOrientation };
+        int startEdge{ start.edgeOrientation };
+        int startUDSlice{ start.udSlice };
+
+        if (tables.tier == EXACT) { // every state on the walk is one of the nodes an IDA* search would visit
+            std::vector<int> moves{ phase1Walk(tables, startCorner, startEdge, startUDSlice) };
+            limits.nodes += static_cast<long long>(moves.size()) + 1;
+            return moves;
+        }
+
+        int threshold{ std::max(phase1Bound(tables, startCorner, startEdge, startUDSlice), 1) };
         std::vector<int> path{};
 
         static const std::map<int, int> oppFaces{
@@ -298,7 +1168,13 @@ namespace Solver {
         const auto dfsPhase1 = [&](auto&& self, State state) {
             auto [corner, edge, udSlice, g, thresh, lastMove] = state;
 
-            int h{ pruneTable[corner * 2048 + edge] };
+            if (limits.visit()) return searchStopped;
+
+            int h{ phase1Bound(tables, corner, edge, udSlice) };
+            TranspositionTable* transpositions{ thresh - g >= transpositionMinDepth ? limits.transpositions : nullptr };
+            const std::uint64_t key{ transpositions ? phase1Key(corner, edge, udSlice, lastMove) : 0 };
+            if (transpositions) h = std::max(h, transpositions->lookup(key));
+
             int f{ g + h };
 
             if (f > thresh) return f;
@@ -310,11 +1186,11 @@ namespace Solver {
                 if (move / 3 == lastMove / 3) continue; // same face
                 if (oppFaces.at(move / 3) == lastMove / 3) continue; // opposite face
 
-                int newCorner{ cornerTable[corner * 18 + move] };
-                int newEdge{ edgeTable[edge * 18 + move] };
-                int newUDSlice{ udSliceTable[udSlice * 18 + move] };
+                int newCorner{ cornerTable(corner, move) };
+                int newEdge{ edgeTable(edge, move) };
+                int newUDSlice{ udSliceTable(udSlice, move) };
 
-                int childH{ pruneTable[newCorner * 2048 + newEdge] };
+                int childH{ phase1Bound(tables, newCorner, newEdge, newUDSlice) };
                 if (g + 1 + childH > thresh) {
                     minOver = std::min(minOver, g + 1 + childH);
                     continue;
@@ -323,10 +1199,12 @@ namespace Solver {
                 path.push_back(move);
                 int t{ self(self, {newCorner, newEdge, newUDSlice, g + 1, thresh, move}) };
                 if (t == -1) return -1;
+                if (t == searchStopped) return searchStopped;
                 if (t < minOver) minOver = t;
                 path.pop_back();
             }
 
+            if (transpositions) transpositions->store(key, minOver - g); // nothing below is shorter
             return minOver;
             };
 
@@ -337,15 +1215,73 @@ namespace Solver {
                 return path;
             }
 
-            if (nextThreshold == (1 << 30)) {
-                std::cout << "No solution found\n";
+            if (nextThreshold == searchStopped) {
+                break;
+            }
+
+            if (nextThreshold == (1 << 30)) { // nothing left to search, only possible with broken tables
                 break;
             }
 
             threshold = nextThreshold;
         }
 
-        return {};
+        return std::nullopt;
+    }
+
+    constexpr int oppositeFace(int face) {
+        return face < 4 ? (face + 2) % 4 : 9 - face; // FRBLUD
+    }
+
+    // calls onSolution with every phase 1 solution of exactly length moves that does not end in a phase 2 move
+    // (those are shorter solutions followed by the start of phase 2), until it returns false or the search is
+    // stopped; returns false in both of those cases
+    template <typename Callback>
+    bool forEachPhase1Solution(const Cube& cube, int length, const Tables& tables, SearchControl& limits, Callback&& onSolution) {
+        TRACE_SCOPE("forEachPhase1Solution");
+
+        const auto& cornerTable{ tables.cornerOrientation1 };
+        const auto& edgeTable{ tables.edgeOrientation1 };
+        const auto& udSliceTable{ tables.udSlice1 };
+
+        std::vector<int> path{};
+        bool keepGoing{ true };
+        const bool exact{ tables.tier == EXACT };
+
+        // distance is exact with EXACT tables and unused otherwise
+        const auto dfs = [&](auto&& self, int corner, int edge, int udSlice, int distance, int g, int lastMove) -> void {
+            if (limits.visit()) {
+                keepGoing = false;
+                return;
+            }
+
+            if (g + (exact ? distance : phase1Bound(tables, corner, edge, udSlice)) > length) return;
+
+            if (g == length) {
+                const bool endsInPhase2Move{ lastMove >= 0 && (lastMove / 3 >= 4 || lastMove % 3 == 1) };
+                if (corner == 0 && edge == 0 && udSlice == 0 && !endsInPhase2Move) keepGoing = onSolution(static_cast<const std::vector<int>&>(path));
+                return;
+            }
+
+            for (int move = 0; move < 18 && keepGoing; move++) {
+                if (lastMove >= 0 && move / 3 == lastMove / 3) continue; // same face
+                if (lastMove >= 0 && move / 3 == oppositeFace(lastMove / 3) && move / 3 < lastMove / 3) continue; // opposite faces commute, keep one order
+
+                const int newCorner{ cornerTable(corner, move) };
+                const int newEdge{ edgeTable(edge, move) };
+                const int newUDSlice{ udSliceTable(udSlice, move) };
+                const int newDistance{ exact ? phase1NeighbourDistance(tables, distance, newCorner, newEdge, newUDSlice) : 0 };
+
+                path.push_back(move);
+                self(self, newCorner, newEdge, newUDSlice, newDistance, g + 1, move);
+                path.pop_back();
+            }
+            };
+
+        const Coordinates start{ getCoordinates(FaceletCube::fromFaceColors(cube.faceColors)) };
+        const int startDistance{ exact ? phase1Distance(tables, start.cornerOrientation, start.edgeOrientation, start.udSlice) : 0 };
+        dfs(dfs, start.cornerOrientation, start.edgeOrientation, start.udSlice, startDistance, 0, -1);
+        return keepGoing;
     }
 
     bool isSameCorner(std::array<sf::Color, 3> a, std::array<sf::Color, 3> b) {
@@ -523,14 +1459,12 @@ namespace Solver {
         std::vector<bool> visited(length, false);
         int visitedCount{ 0 };
 
-        Cube cube{ 0.f };
-
-        std::vector<std::pair<int, FaceColors>> v{ {0, cube.faceColors} };
+        std::vector<std::pair<int, FaceletCube>> v{ {0, FaceletCube{}} };
 
         int head{ 0 };
 
         while (head < v.size()) {
-            auto [coord, colors] = v[head++];
+            auto [coord, state] = v[head++];
             if (coord < 0 || coord >= length) {
                 std::cout << "Invalid coord: " << coord << '\n';
                 continue;
@@ -543,24 +1477,23 @@ namespace Solver {
             visitedCount++;
 
             for (int i = 0; i < 4; i++) {
-                cube.faceColors = colors;
-                moveCube(cube, "FRBL"[i]);
-                moveCube(cube, "FRBL"[i]);
-                const int newCoord{ coordFunc(cube.faceColors) };
+                FaceletCube next{ state };
+                next.move(i * 3 + 1); // half turn of F, R, B or L
+                const int newCoord{ coordFunc(next.toFaceColors()) };
                 table[coord * 10 + i] = newCoord;
                 if (!visited[newCoord]) {
-                    v.emplace_back(newCoord, cube.faceColors);
+                    v.emplace_back(newCoord, next);
                 }
             }
 
             for (int i = 0; i < 2; i++) {
-                cube.faceColors = colors;
+                FaceletCube next{ state };
                 for (int j = 0; j < 3; j++) {
-                    moveCube(cube, "UD"[i]);
-                    const int newCoord{ coordFunc(cube.faceColors) };
+                    next.move((4 + i) * 3); // quarter turn of U or D
+                    const int newCoord{ coordFunc(next.toFaceColors()) };
                     table[coord * 10 + (4 + i * 3 + j)] = newCoord;
                     if (!visited[newCoord]) {
-                        v.emplace_back(newCoord, cube.faceColors);
+                        v.emplace_back(newCoord, next);
                     }
                 }
             }
@@ -633,6 +1566,46 @@ namespace Solver {
         out.close();
     }
 
+    // the phase 2 move undoing move: half turns undo themselves, U undoes U' and so on
+    constexpr int inversePhase2Move(int move) {
+        return move < 4 ? move : 4 + (move - 4) / 3 * 3 + 2 - (move - 4) % 3;
+    }
+
+    // every phase 2 state within depth moves of solved by breadth first search, each with its distance and the move
+    // back towards solved, for the endgame table
+    void generatePhase2EndgameTable(int depth = endgameDepth) {
+        const auto cornerTable{ loadTable("cornerPermutation2.bin", factorial[8] * 10) };
+        const auto edgeTable{ loadTable("edgePermutation2.bin", factorial[8] * 10) };
+        const auto udSliceTable{ loadTable("UDPermutation2.bin", 24 * 10) };
+
+        struct Coords { int corner, edge, udSlice; };
+        std::vector<Coords> frontier{ { 0, 0, 0 } };
+        std::unordered_set<std::uint64_t> seen{ phase2Index(0, 0, 0) };
+        std::vector<std::uint64_t> entries{ EndgameTable::pack(phase2Index(0, 0, 0), 0, 0) };
+
+        for (int distance = 1; distance <= depth; distance++) {
+            std::vector<Coords> next{};
+
+            for (const Coords& state : frontier) {
+                for (int move = 0; move < 10; move++) {
+                    const Coords neighbour{ cornerTable[state.corner * 10 + move], edgeTable[state.edge * 10 + move], udSliceTable[state.udSlice * 10 + move] };
+                    const std::uint64_t key{ phase2Index(neighbour.corner, neighbour.edge, neighbour.udSlice) };
+
+                    if (!seen.insert(key).second) continue;
+
+                    entries.push_back(EndgameTable::pack(key, distance, inversePhase2Move(move)));
+                    next.push_back(neighbour);
+                }
+            }
+
+            std::cout << "Depth " << distance << ": " << next.size() << " states\n";
+            frontier = std::move(next);
+        }
+
+        std::ofstream out("phase2Endgame.bin", std::ios::binary);
+        out.write(reinterpret_cast<const char*>(entries.data()), entries.size() * sizeof(entries[0]));
+    }
+
     void generateAllTables() {
         generateMoveTablePhase1(2187, getCornerOrientation, "cornerOrientation1.bin");
         generateMoveTablePhase1(2048, getEdgeOrientation, "edgeOrientation1.bin");
@@ -646,31 +1619,70 @@ namespace Solver {
 
         generatePhase2PruneTable();
         generatePhase2PruningTable2();
+        generatePhase2EndgameTable();
     }
 
-    std::vector<int> idaPhase2Search(const Cube& cube) {
-        auto cornerTable = loadTable("cornerPermutation2.bin", factorial[8] * 10);
-        auto edgeTable = loadTable("edgePermutation2.bin", factorial[8] * 10);
-        auto udSliceTable = loadTable("UDPermutation2.bin", 24 * 10);
-        auto pruneTable1 = loadTable("pruningTable2-1.bin", factorial[8]);
-        auto pruneTable2 = loadTable("pruningTable2-2.bin", factorial[8]);
+    // nothing if the search was stopped first or every solution is longer than maxLength
+    std::optional<std::vector<int>> idaPhase2Search(const Cube& cube, const Tables& tables = getTables(), SearchControl* control = nullptr, int maxLength = 1 << 30) {
+        TRACE_SCOPE("idaPhase2Search");
 
-        int startCorner{ getCornerPermutation(cube.faceColors) };
-        int startEdge{ getEdgePermutation(cube.faceColors) };
-        int startUDSlice{ getUDSlicePermutation(cube.faceColors) };
+        SearchControl unlimited{};
+        SearchControl& limits{ control ? *control : unlimited };
+        if (limits.check()) return std::nullopt;
 
-        int threshold{ std::max({ pruneTable1[startCorner], pruneTable2[startEdge], 1 }) };
+        const auto& cornerTable{ tables.cornerPermutation2 };
+        const auto& edgeTable{ tables.edgePermutation2 };
+        const auto& udSliceTable{ tables.udPermutation2 };
+        const auto& pruneTable1{ tables.prune2Corner };
+        const auto& pruneTable2{ tables.prune2Edge };
+        const EndgameTable& endgame{ tables.endgame2 };
+
+        const Coordinates start{ getCoordinates(FaceletCube::fromFaceColors(cube.faceColors)) };
+        int startCorner{ start.cornerPermutation };
+        int startEdge{ start.edgePermutation };
+        int startUDSlice{ start.udSlicePermutation };
+
+        if (std::max<int>(pruneTable1[startCorner], pruneTable2[startEdge]) > maxLength) return std::nullopt;
+
+        int threshold{ std::max<int>({ pruneTable1[startCorner], pruneTable2[startEdge], 1 }) };
         std::vector<int> path{};
 
         const auto dfs = [&](auto&& self, State state) {
             auto [corner, edge, udSlice, g, thresh, lastMove] = state;
 
+            if (limits.visit()) return searchStopped;
+
             int h{ std::max({pruneTable1[corner], pruneTable2[edge]}) };
+            TranspositionTable* transpositions{ thresh - g >= transpositionMinDepth ? limits.transpositions : nullptr };
+            const std::uint64_t key{ transpositions ? phase2Key(corner, edge, udSlice, lastMove) : 0 };
+            if (transpositions) h = std::max(h, transpositions->lookup(key));
+
             int f{ g + h };
 
             if (f > thresh) return f;
-            if (corner == 0 && edge == 0 && udSlice == 0) return -1;
 
+            if (!endgame.empty()) { // the exact distance near the goal, and more than the table's depth elsewhere
+                EndgameTable::Hit hit{ endgame.lookup(phase2Index(corner, edge, udSlice)) };
+
+                if (hit.distance < 0) {
+                    if (g + endgame.getDepth() + 1 > thresh) return g + endgame.getDepth() + 1;
+                }
+                else if (g + hit.distance > thresh) {
+                    return g + hit.distance;
+                }
+                else {
+                    for (; hit.distance > 0; hit = endgame.lookup(phase2Index(corner, edge, udSlice))) { // finish by lookups
+                        path.push_back(hit.move);
+                        corner = cornerTable(corner, hit.move);
+                        edge = edgeTable(edge, hit.move);
+                        udSlice = udSliceTable(udSlice, hit.move);
+                    }
+
+                    return -1;
+                }
+            }
+
+            if (corner == 0 && edge == 0 && udSlice == 0) return -1;
 
             int minOver{ 1 << 30 };
 
@@ -681,9 +1693,9 @@ namespace Solver {
                 if ((move == 0 && lastMove == 2) || (move == 2 && lastMove == 0) || (move == 1 && lastMove == 3) || (move == 3 && lastMove == 1)) continue; // opposite face
                 if (move >= 4 && lastMove >= 4 && (((move - 4) / 3 == 0 && (lastMove - 4) / 3 == 1) || ((move - 4) / 3 == 1 && (lastMove - 4) / 3 == 0))) continue; // opposite face
 
-                int newCorner{ cornerTable[corner * 10 + move] };
-                int newEdge{ edgeTable[edge * 10 + move] };
-                int newUDSlice{ udSliceTable[udSlice * 10 + move] };
+                int newCorner{ cornerTable(corner, move) };
+                int newEdge{ edgeTable(edge, move) };
+                int newUDSlice{ udSliceTable(udSlice, move) };
 
                 int childH{ std::max({pruneTable1[newCorner], pruneTable2[newEdge]}) };
                 if (g + 1 + childH > thresh) {
@@ -694,10 +1706,12 @@ namespace Solver {
                 path.push_back(move);
                 int t{ self(self, {newCorner, newEdge, newUDSlice, g + 1, thresh, move}) };
                 if (t == -1) return -1;
+                if (t == searchStopped) return searchStopped;
                 if (t < minOver) minOver = t;
                 path.pop_back();
             }
 
+            if (transpositions) transpositions->store(key, minOver - g); // nothing below is shorter
             return minOver;
             };
 
@@ -708,48 +1722,330 @@ namespace Solver {
                 return path;
             }
 
-            if (nextThreshold == (1 << 30)) {
-                std::cout << "No solution found\n";
+            if (nextThreshold == searchStopped) {
+                break;
+            }
+
+            if (nextThreshold == (1 << 30)) { // nothing left to search, only possible with broken tables
+                break;
+            }
+
+            if (nextThreshold > maxLength) {
                 break;
             }
 
             threshold = nextThreshold;
         }
 
-        return {};
+        return std::nullopt;
     }
 
-    std::vector<char> solve(const Cube& cube) {
-        std::vector<char> moves{};
+    // moves as the phase 1 search numbers them: face * 3 + (quarter turns - 1), faces in FRBLUD order
+    std::vector<char> toQuarterTurns(const std::vector<int>& moves) {
+        std::vector<char> quarterTurns{};
 
-        Cube tempCube{ cube };
-        int length{ 0 };
+        for (int move : moves) {
+            for (int i = 0; i < (move % 3) + 1; i++) {
+                quarterTurns.push_back("FRBLUD"[move / 3]);
+            }
+        }
 
-        for (int move : idaPhase1Search(cube)) {
-            length++;
+        return quarterTurns;
+    }
+
+    void applyFaceTurns(Cube& cube, const std::vector<int>& moves) {
+        for (int move : moves) {
             for (int i = 0; i < (move % 3) + 1; i++) {
-                moves.push_back("FRBLUD"[move / 3]);
-                moveCube(tempCube, "FRBLUD"[move / 3]);
+                moveCube(cube, "FRBLUD"[move / 3]);
             }
         }
+    }
 
-        for (int move : idaPhase2Search(tempCube)) {
-            length++;
-            if (move < 4) {
-                for (int i = 0; i < 2; i++) {
-                    moves.push_back("FRBL"[move]);
-                    moveCube(tempCube, "FRBL"[move]);
+    // a phase 2 move as a face turn numbered like phase 1 moves
+    constexpr int phase2FaceTurn(int move) {
+        if (move < 4) return move * 3 + 1; // F2, R2, B2, L2
+        return (4 + (move - 4) / 3) * 3 + (move - 4) % 3; // U, U2, U', D, D2, D'
+    }
+
+    enum SolveStatus {
+        SOLVED,    // moves holds the solution
+        TIMED_OUT, // the deadline passed first, moves holds the best solution found by then if there was one
+        CANCELLED, // the token was cancelled first, moves as for TIMED_OUT
+        INVALID_CUBE,
+        NOT_FOUND  // the search ended without a solution, which only happens with missing or broken tables
+    };
+
+    struct SolveOptions {
+        std::optional<SolveClock::time_point> deadline{};
+        const CancellationToken* token{ nullptr };
+        TranspositionTable* transpositions{ nullptr }; // may be shared by concurrent and later solves
+        std::optional<int> targetLength{}; // keep looking for shorter solutions until one has at most this many moves
+        int phase2Threads{ 0 };            // with a target length, complete phase 1 solutions on this many threads
+
+        // without a target length, called with the phase 1 moves as soon as phase 1 finishes; they are also the
+        // start of the final solution, so the caller can start acting on them while phase 2 runs
+        std::function<void(const std::vector<int>&)> onPhase1{};
+    };
+
+    struct SolveStats {
+        long long phase1Nodes{ 0 };
+        long long phase2Nodes{ 0 };
+        double phase1Seconds{ 0 };
+        double phase2Seconds{ 0 }; // summed over the phase 2 threads
+        int phase1Solutions{ 0 }; // phase 1 solutions phase 2 was run on
+    };
+
+    struct SolveResult {
+        SolveStatus status{ SOLVED };
+        Validity validity{ VALID };
+        std::optional<std::vector<int>> moves{}; // face turns numbered like phase 1 moves
+        SolveStats stats{};
+    };
+
+    // the improving search of solveWithOptions as a pipeline: the calling thread enumerates phase 1 solutions into a
+    // lock-free queue while options.phase2Threads workers complete them, each bounded by the best total so far
+    void solvePipelined(const Cube& cube, const SolveOptions& options, const Tables& tables, SolveResult& result) {
+        CancellationToken finished{ options.token }; // also cancelled once the target is met
+        SearchControl phase1{ options.token, options.deadline, options.transpositions };
+
+        BoundedQueue<std::vector<int>> candidates{ 64 };
+        // pushes and pops go through the lock-free queue; the mutex is only taken to sleep, by idle workers on pushed
+        // and by a producer facing a full queue on popped, and to wake a sleeper, which the counters below tell about.
+        // Each side publishes that it sleeps, then fences, then retries the queue, and the other side changes the
+        // queue, fences, then reads the counter, so one of them always sees the other.
+        std::mutex queueMutex{};
+        std::condition_variable pushed{};
+        std::condition_variable popped{};
+        std::atomic<int> idleWorkers{ 0 };
+        std::atomic<bool> producerWaiting{ false };
+        std::atomic<bool> producing{ true };
+        std::atomic<int> bestLength{ 1 << 30 };
+        std::mutex resultMutex{};
+        bool phase2Stopped{ false };
+
+        const auto start{ SolveClock::now() };
+        const auto targetMet{ [&] { return bestLength.load() <= *options.targetLength; } };
+
+        std::vector<std::thread> workers{};
+
+        for (int i = 0; i < options.phase2Threads; i++) {
+            workers.emplace_back([&] {
+                SearchControl phase2{ &finished, options.deadline, options.transpositions };
+                SolveStats stats{};
+                std::vector<int> phase1Moves{};
+
+                while (true) {
+                    bool taken{ candidates.tryPop(phase1Moves) };
+
+                    if (!taken) {
+                        std::unique_lock lock{ queueMutex };
+                        idleWorkers++;
+                        std::atomic_thread_fence(std::memory_order_seq_cst);
+                        pushed.wait(lock, [&] { return (taken = candidates.tryPop(phase1Moves)) || !producing.load(std::memory_order_acquire); });
+                        idleWorkers--;
+                    }
+
+                    if (!taken) break; // the producer is done and everything is taken
+
+                    std::atomic_thread_fence(std::memory_order_seq_cst);
+                    if (producerWaiting.load(std::memory_order_relaxed)) {
+                        { std::lock_guard lock{ queueMutex }; }
+                        popped.notify_one();
+                    }
+
+                    const int maxLength{ bestLength.load() - static_cast<int>(phase1Moves.size()) - 1 };
+                    if (maxLength < 0 || finished.isCancelled()) continue;
+
+                    Cube tempCube{ cube };
+                    applyFaceTurns(tempCube, phase1Moves);
+
+                    const auto phase2Start{ SolveClock::now() };
+                    std::optional<std::vector<int>> phase2Moves{ idaPhase2Search(tempCube, tables, &phase2, maxLength) };
+                    stats.phase2Seconds += std::chrono::duration<double>(SolveClock::now() - phase2Start).count();
+                    stats.phase1Solutions++;
+
+                    if (!phase2Moves) continue;
+
+                    std::lock_guard lock{ resultMutex };
+
+                    if (static_cast<int>(phase1Moves.size() + phase2Moves->size()) < bestLength.load()) {
+                        result.moves = phase1Moves;
+                        for (int move : *phase2Moves) result.moves->push_back(phase2FaceTurn(move));
+
+                        bestLength = static_cast<int>(result.moves->size());
+                        if (targetMet()) finished.cancel();
+                    }
                 }
-            }
-            else {
-                for (int i = 0; i < (move - 4) % 3 + 1; i++) {
-                    moves.push_back("UD"[(move - 4) / 3]);
-                    moveCube(tempCube, "UD"[(move - 4) / 3]);
+
+                std::lock_guard lock{ resultMutex };
+                result.stats.phase2Nodes += phase2.nodes;
+                result.stats.phase2Seconds += stats.phase2Seconds;
+                result.stats.phase1Solutions += stats.phase1Solutions;
+                phase2Stopped = phase2Stopped || phase2.stopped;
+                });
+        }
+
+        for (int length = 0; length <= 20 && length < bestLength.load() && !finished.isCancelled(); length++) {
+            const bool more{ forEachPhase1Solution(cube, length, tables, phase1, [&](const std::vector<int>& phase1Moves) {
+                std::vector<int> candidate{ phase1Moves };
+                bool queued{ candidates.tryPush(std::move(candidate)) };
+
+                while (!queued) { // full: wait for the workers, but not past the deadline
+                    if (finished.isCancelled() || phase1.check()) return false;
+
+                    std::unique_lock lock{ queueMutex };
+                    producerWaiting.store(true, std::memory_order_relaxed);
+                    std::atomic_thread_fence(std::memory_order_seq_cst);
+                    popped.wait_for(lock, std::chrono::milliseconds{ 1 }, [&] { return queued = candidates.tryPush(std::move(candidate)); });
+                    producerWaiting.store(false, std::memory_order_relaxed);
                 }
+
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                if (idleWorkers.load(std::memory_order_relaxed) > 0) {
+                    { std::lock_guard lock{ queueMutex }; }
+                    pushed.notify_one();
+                }
+
+                return length < bestLength.load() && !finished.isCancelled();
+                }) };
+
+            if (!more) break;
+        }
+
+        result.stats.phase1Seconds = std::chrono::duration<double>(SolveClock::now() - start).count();
+        {
+            std::lock_guard lock{ queueMutex };
+            producing.store(false, std::memory_order_release);
+        }
+
+        pushed.notify_all();
+
+        for (auto& worker : workers) worker.join();
+
+        result.stats.phase1Nodes = phase1.nodes;
+        if (!targetMet() && (phase1.stopped || phase2Stopped)) result.status = options.token && options.token->isCancelled() ? CANCELLED : TIMED_OUT;
+    }
+
+    // two-phase solve that gives up at the deadline or when the token is cancelled. Without a target length the
+    // first solution is returned; with one, phase 1 solutions of increasing length are each completed by a phase
+    // 2 search bounded by the best solution so far, until the target is met, nothing shorter can exist, or the
+    // search is stopped, in which case the best solution found by then is returned.
+    // With phase2Threads as well, that search runs as a pipeline on that many extra threads.
+    SolveResult solveWithOptions(const Cube& cube, const SolveOptions& options = {}, const Tables& tables = getTables()) {
+        SolveResult result{};
+
+        if (result.validity = validate(cube.faceColors); result.validity != VALID) {
+            result.status = INVALID_CUBE;
+            return result;
+        }
+
+        if (options.targetLength && options.phase2Threads > 0) {
+            solvePipelined(cube, options, tables, result);
+            if (result.status == SOLVED && !result.moves) result.status = NOT_FOUND;
+            return result;
+        }
+
+        SearchControl phase1{ options.token, options.deadline, options.transpositions };
+        SearchControl phase2{ options.token, options.deadline, options.transpositions };
+
+        const auto start{ SolveClock::now() };
+        const auto secondsSince{ [](SolveClock::time_point from) { return std::chrono::duration<double>(SolveClock::now() - from).count(); } };
+
+        const auto finishPhase2{ [&](const std::vector<int>& phase1Moves, int maxLength) {
+            Cube tempCube{ cube };
+            applyFaceTurns(tempCube, phase1Moves);
+
+            const auto phase2Start{ SolveClock::now() };
+            std::optional<std::vector<int>> phase2Moves{ idaPhase2Search(tempCube, tables, &phase2, maxLength) };
+            result.stats.phase2Seconds += secondsSince(phase2Start);
+            result.stats.phase1Solutions++;
+
+            if (!phase2Moves) return false;
+
+            result.moves = phase1Moves;
+            for (int move : *phase2Moves) result.moves->push_back(phase2FaceTurn(move));
+            return true;
+            } };
+
+        if (!options.targetLength) {
+            const std::optional<std::vector<int>> phase1Moves{ idaPhase1Search(cube, tables, &phase1) };
+
+            if (phase1Moves) {
+                if (options.onPhase1) options.onPhase1(*phase1Moves);
+                finishPhase2(*phase1Moves, 1 << 30);
             }
         }
+        else {
+            const auto targetMet{ [&] { return result.moves && static_cast<int>(result.moves->size()) <= *options.targetLength; } };
 
-        std::cout << "Solution length: " << length << '\n';
-        return moves;
+            for (int length = 0; length <= 20 && !targetMet(); length++) {
+                if (result.moves && length >= static_cast<int>(result.moves->size())) break;
+
+                const bool finished{ forEachPhase1Solution(cube, length, tables, phase1, [&](const std::vector<int>& phase1Moves) {
+                    finishPhase2(phase1Moves, result.moves ? static_cast<int>(result.moves->size()) - length - 1 : 1 << 30);
+                    return !phase2.stopped && !targetMet();
+                    }) };
+
+                if (!finished) break;
+            }
+        }
+
+        result.stats.phase1Nodes = phase1.nodes;
+        result.stats.phase2Nodes = phase2.nodes;
+        result.stats.phase1Seconds = secondsSince(start) - result.stats.phase2Seconds;
+
+        if (phase1.stopped || phase2.stopped) result.status = options.token && options.token->isCancelled() ? CANCELLED : TIMED_OUT;
+        else if (!result.moves) result.status = NOT_FOUND;
+        return result;
+    }
+
+    // two-phase solution of a valid cube as face turns numbered like phase 1 moves,
+    // or nothing if the token was cancelled first
+    std::optional<std::vector<int>> solveFaceTurns(const Cube& cube, const Tables& tables = getTables(), const CancellationToken* token = nullptr) {
+        SolveOptions options{};
+        options.token = token;
+
+        SolveResult result{ solveWithOptions(cube, options, tables) };
+        if (result.status != SOLVED) return std::nullopt;
+
+        return result.moves;
+    }
+
+    std::vector<char> solve(const Cube& cube, const Tables& tables = getTables()) {
+        const SolveResult result{ solveWithOptions(cube, {}, tables) };
+
+        if (result.status == INVALID_CUBE) {
+            std::cout << "Invalid cube: " << describeValidity(result.validity) << '\n';
+            return {};
+        }
+
+        if (!result.moves) {
+            std::cout << "No solution found\n";
+            return {};
+        }
+
+        std::cout << "Solution length: " << result.moves->size() << '\n';
+        return toQuarterTurns(*result.moves);
+    }
+
+    // quarter turns as standard notation, e.g. R R R U U -> "R' U2"
+    std::string formatMoves(const std::vector<char>& moves) {
+        std::string text{};
+
+        for (size_t i = 0; i < moves.size();) {
+            size_t run{ 0 };
+            while (i + run < moves.size() && moves[i + run] == moves[i]) run++;
+
+            if (run % 4 != 0) {
+                if (!text.empty()) text += ' ';
+                text += moves[i];
+                if (run % 4 == 2) text += '2';
+                if (run % 4 == 3) text += '\'';
+            }
+
+            i += run;
+        }
+
+        return text;
     }
 }
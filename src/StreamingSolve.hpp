@@ -0,0 +1,88 @@
+#pragma once
+
+#include <iostream>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "Cube.hpp"
+#include "Solver.hpp"
+
+// Solves a cube on a background thread and hands the moves over as they become known: the phase 1 moves as soon as
+// phase 1 finishes, so they can be animated while phase 2 is still searching, then the phase 2 moves. Until it is
+// finished the cube must not be turned any other way, or the phase 2 moves no longer fit it.
+class StreamingSolve {
+    Solver::CancellationToken m_token{};
+    std::mutex m_mutex{};
+    std::vector<char> m_moves{}; // quarter turns not taken yet
+    bool m_finished{ false };
+    std::optional<Solver::SolveStats> m_stats{}; // of a solve that found a solution
+    std::thread m_thread{};
+
+    void solve(const Cube& cube, const Solver::Tables& tables) {
+        size_t phase1Length{ 0 };
+
+        Solver::SolveOptions options{};
+        options.token = &m_token;
+        options.onPhase1 = [&](const std::vector<int>& phase1Moves) {
+            phase1Length = phase1Moves.size();
+            append(Solver::toQuarterTurns(phase1Moves));
+            };
+
+        if (!tables.complete) std::cout << "Some table files are missing or short, solutions may be wrong\n";
+
+        const Solver::SolveResult result{ Solver::solveWithOptions(cube, options, tables) };
+
+        if (result.status == Solver::INVALID_CUBE) {
+            std::cout << "Invalid cube: " << Solver::describeValidity(result.validity) << '\n';
+        }
+        else if (result.moves) {
+            std::cout << "Solution length: " << result.moves->size() << '\n';
+            append(Solver::toQuarterTurns(std::vector<int>(result.moves->begin() + phase1Length, result.moves->end())));
+        }
+        else if (result.status != Solver::CANCELLED) {
+            std::cout << "No solution found\n";
+        }
+
+        std::lock_guard lock{ m_mutex };
+        if (result.moves) m_stats = result.stats;
+        m_finished = true;
+    }
+
+    void append(const std::vector<char>& moves) {
+        std::lock_guard lock{ m_mutex };
+        m_moves.insert(m_moves.end(), moves.begin(), moves.end());
+    }
+
+public:
+    explicit StreamingSolve(const Cube& cube, const Solver::Tables& tables = Solver::getTables()) :
+        m_thread([this, cube, &tables] { solve(cube, tables); }) {}
+
+    ~StreamingSolve() {
+        m_token.cancel();
+        m_thread.join();
+    }
+
+    StreamingSolve(const StreamingSolve&) = delete;
+    StreamingSolve& operator=(const StreamingSolve&) = delete;
+
+    // quarter turns found since the last call
+    std::vector<char> takeMoves() {
+        std::lock_guard lock{ m_mutex };
+        return std::exchange(m_moves, {});
+    }
+
+    // no more moves will come; moves may still be waiting to be taken
+    bool isFinished() {
+        std::lock_guard lock{ m_mutex };
+        return m_finished;
+    }
+
+    // once finished, the search statistics if a solution was found
+    std::optional<Solver::SolveStats> getStats() {
+        std::lock_guard lock{ m_mutex };
+        return m_stats;
+    }
+};
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+// Memory for the large search tables. Lookups in the searches are random, so on Linux the tables are placed on
+// 2 MB pages: explicitly reserved huge pages if the host has any, otherwise a 2 MB aligned mapping with
+// transparent huge pages requested. Elsewhere, and for small tables, it is a plain 64 byte aligned allocation.
+namespace TableMemory {
+    constexpr size_t hugePageSize{ 2 * 1024 * 1024 };
+
+    inline std::shared_ptr<void> allocatePlain(size_t bytes) {
+        void* memory{ ::operator new(bytes == 0 ? 1 : bytes, std::align_val_t{ 64 }) };
+        return std::shared_ptr<void>{ memory, [](void* address) { ::operator delete(address, std::align_val_t{ 64 }); } };
+    }
+
+    inline std::shared_ptr<void> allocate(size_t bytes) {
+#if defined(__linux__)
+        if (bytes >= hugePageSize / 2) {
+            const size_t rounded{ (bytes + hugePageSize - 1) / hugePageSize * hugePageSize };
+
+#ifdef MAP_HUGETLB
+            void* huge{ mmap(nullptr, rounded, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0) };
+            if (huge != MAP_FAILED) {
+                return std::shared_ptr<void>{ huge, [rounded](void* address) { munmap(address, rounded); } };
+            }
+#endif
+
+            // over-allocate so the table can start on a 2 MB boundary, which transparent huge pages need
+            const size_t mapped{ rounded + hugePageSize };
+            void* base{ mmap(nullptr, mapped, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0) };
+
+            if (base != MAP_FAILED) {
+                const std::uintptr_t start{ reinterpret_cast<std::uintptr_t>(base) };
+                void* aligned{ reinterpret_cast<void*>((start + hugePageSize - 1) / hugePageSize * hugePageSize) };
+#ifdef MADV_HUGEPAGE
+                madvise(aligned, rounded, MADV_HUGEPAGE);
+#endif
+                return std::shared_ptr<void>{ aligned, [base, mapped](void*) { munmap(base, mapped); } };
+            }
+        }
+#endif
+        return allocatePlain(bytes);
+    }
+}
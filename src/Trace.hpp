@@ -0,0 +1,116 @@
+#pragma once
+
+// Scoped timing zones written as Chrome trace-event JSON (open in chrome://tracing or https://ui.perfetto.dev).
+// Compiled in only with CUBE_ENABLE_TRACE defined (cmake -DCUBE_ENABLE_TRACE=ON); otherwise TRACE_SCOPE expands to
+// nothing. The trace goes to the file named by the CUBE_TRACE_FILE environment variable, or trace.json, when the
+// program exits.
+
+#ifdef CUBE_ENABLE_TRACE
+
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace Trace {
+    using Clock = std::chrono::steady_clock;
+
+    struct Event {
+        const char* name; // a string literal
+        Clock::time_point start;
+        Clock::time_point end;
+    };
+
+    // one per thread, kept by the session so events outlive the thread that recorded them
+    struct ThreadEvents {
+        int id{};
+        std::mutex mutex{}; // only contended while the trace is written
+        std::vector<Event> events{};
+    };
+
+    class Session {
+        Clock::time_point m_start{ Clock::now() };
+        std::mutex m_mutex{};
+        std::vector<std::shared_ptr<ThreadEvents>> m_threads{};
+
+    public:
+        ~Session() {
+            const char* path{ std::getenv("CUBE_TRACE_FILE") };
+            write(path ? path : "trace.json");
+        }
+
+        std::shared_ptr<ThreadEvents> addThread() {
+            std::lock_guard lock{ m_mutex };
+
+            auto thread{ std::make_shared<ThreadEvents>() };
+            thread->id = static_cast<int>(m_threads.size()) + 1;
+            m_threads.push_back(thread);
+
+            return thread;
+        }
+
+        void write(const char* path) {
+            std::ofstream out{ path };
+            out << "{\"traceEvents\":[";
+
+            const auto microseconds{ [this](Clock::time_point time) { return std::chrono::duration<double, std::micro>(time - m_start).count(); } };
+            bool first{ true };
+
+            std::lock_guard lock{ m_mutex };
+
+            for (const auto& thread : m_threads) {
+                std::lock_guard threadLock{ thread->mutex };
+
+                for (const Event& event : thread->events) {
+                    out << (first ? "" : ",") << "\n{\"name\":\"" << event.name << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << thread->id
+                        << ",\"ts\":" << microseconds(event.start) << ",\"dur\":" << microseconds(event.end) - microseconds(event.start) << '}';
+                    first = false;
+                }
+            }
+
+            out << "\n],\"displayTimeUnit\":\"ms\"}\n";
+        }
+    };
+
+    inline Session& session() {
+        static Session instance{};
+        return instance;
+    }
+
+    inline ThreadEvents& threadEvents() {
+        thread_local const std::shared_ptr<ThreadEvents> events{ session().addThread() };
+        return *events;
+    }
+
+    // records the time from construction to destruction as one complete event
+    class Zone {
+        const char* m_name;
+        ThreadEvents& m_thread; // looked up first so the session starts before the first zone does
+        Clock::time_point m_start;
+
+    public:
+        explicit Zone(const char* name) : m_name(name), m_thread(threadEvents()), m_start(Clock::now()) {}
+
+        ~Zone() {
+            const Clock::time_point end{ Clock::now() };
+
+            std::lock_guard lock{ m_thread.mutex };
+            m_thread.events.push_back({ m_name, m_start, end });
+        }
+
+        Zone(const Zone&) = delete;
+        Zone& operator=(const Zone&) = delete;
+    };
+}
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+#define TRACE_SCOPE(name) const Trace::Zone TRACE_CONCAT(traceZone, __LINE__){ name }
+
+#else
+
+#define TRACE_SCOPE(name) ((void)0)
+
+#endif
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+// Lower bounds on the distance to the goal learned by the IDA* searches: once a node's subtree is searched in vain
+// up to some threshold, no solution through it is shorter than the smallest f that overshot. Later iterations
+// (and later solves, as every search of a phase has the same goal) read the bound back and skip the subtree.
+// Fixed size and shared by threads without locks: an entry is one 64 bit word holding key and bound, so a reader
+// sees either the whole entry or another one, and a colliding key simply replaces it.
+class TranspositionTable {
+    std::unique_ptr<std::atomic<std::uint64_t>[]> m_entries;
+    size_t m_mask;
+
+    static constexpr int keyShift{ 8 }; // keys must stay below 2^56
+
+    size_t index(std::uint64_t key) const {
+        return static_cast<size_t>((key * 0x9e3779b97f4a7c15ULL) >> 20) & m_mask;
+    }
+
+public:
+    // entries is rounded up to a power of two; each takes 8 bytes
+    explicit TranspositionTable(size_t entries = size_t{ 1 } << 22) {
+        size_t size{ 1 };
+        while (size < entries) size *= 2;
+
+        m_entries.reset(new std::atomic<std::uint64_t>[size]());
+        m_mask = size - 1;
+    }
+
+    // 0 if nothing is known about key
+    int lookup(std::uint64_t key) const {
+        const std::uint64_t entry{ m_entries[index(key)].load(std::memory_order_relaxed) };
+        return (entry >> keyShift) == key ? static_cast<int>(entry & 0xff) : 0;
+    }
+
+    void store(std::uint64_t key, int bound) {
+        bound = std::min(bound, 0xff);
+        if (bound <= 0) return;
+
+        std::atomic<std::uint64_t>& slot{ m_entries[index(key)] };
+        const std::uint64_t entry{ slot.load(std::memory_order_relaxed) };
+
+        if ((entry >> keyShift) == key && static_cast<int>(entry & 0xff) >= bound) return;
+        slot.store((key << keyShift) | static_cast<std::uint64_t>(bound), std::memory_order_relaxed);
+    }
+};
@@ -0,0 +1,182 @@
+// Headless solution video export: scrambles a cube, solves it, and plays scramble and solution through the same
+// rotation animation as the window, rasterising every frame on the CPU. Frames are written as numbered PPM
+// images, one directory per clip, or as one raw RGB24 stream on stdout, e.g.
+//   cubeexport --clips 100 --raw | ffmpeg -f rawvideo -pixel_format rgb24 -video_size 640x480 -framerate 60 -i - clips.mp4
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <SFML/Graphics.hpp>
+
+#include "Camera.hpp"
+#include "Cube.hpp"
+#include "Solver.hpp"
+#include "SoftwareRenderer.hpp"
+
+namespace {
+    struct ExportSettings {
+        int clips{ 1 };
+        unsigned seed{ 1 };
+        int scrambleLength{ 25 };
+        int width{ 640 };
+        int height{ 480 };
+        int fps{ 60 };
+        float rotationSpeed{ 500.f }; // degrees per second, as in the window
+        int supersampling{ 2 };
+        int threads{ static_cast<int>(std::max(1u, std::thread::hardware_concurrency())) };
+        std::filesystem::path tables{ "." };
+        std::filesystem::path output{ "clips" };
+        bool raw{ false };
+    };
+
+    constexpr float cubeletSize{ 2.f };
+
+    // random quarter turns, never the same face twice in a row so no turns cancel
+    std::vector<char> randomScramble(std::mt19937& rng, int length) {
+        std::vector<char> moves{};
+
+        while (static_cast<int>(moves.size()) < length) {
+            const char face{ "UDFBLR"[std::uniform_int_distribution<int>{ 0, 5 }(rng)] };
+            if (moves.empty() || moves.back() != face) moves.push_back(face);
+        }
+
+        return moves;
+    }
+
+    // every frame of one clip: a short pause, the scramble, a pause, the solution and a final pause
+    std::vector<Cube> playClip(const std::vector<char>& scramble, const std::vector<char>& solution, const ExportSettings& settings) {
+        Cube cube{ cubeletSize };
+        cube.rotate(0.5f, { 1.f, 0.f, 0.f }); // look at the corner between U, F and R
+        cube.rotate(-0.6f, { 0.f, 1.f, 0.f });
+
+        const float step{ settings.rotationSpeed / static_cast<float>(settings.fps) };
+        const int pause{ settings.fps / 2 };
+
+        std::vector<Cube> frames{};
+
+        const auto animate{ [&](const std::vector<char>& moves) {
+            for (char move : moves) cube.startRotation(move);
+
+            while (cube.getState() != Cube::IDLE) {
+                frames.push_back(cube);
+                cube.manageRotation(step);
+            }
+
+            for (int i = 0; i < pause; i++) frames.push_back(cube);
+            } };
+
+        for (int i = 0; i < pause; i++) frames.push_back(cube);
+        animate(scramble);
+        animate(solution);
+
+        return frames;
+    }
+
+    void exportClip(int clip, const std::vector<Cube>& frames, const ExportSettings& settings) {
+        const Camera camera{ settings.width, settings.height };
+        const std::filesystem::path directory{ settings.output / ("clip" + std::to_string(clip)) };
+
+        if (!settings.raw) std::filesystem::create_directories(directory);
+
+        // frames are rendered in parallel a batch at a time, so a raw stream can be written in order
+        const int batchSize{ settings.threads * 4 };
+        std::vector<std::vector<std::uint8_t>> images(batchSize);
+
+        for (size_t batchStart = 0; batchStart < frames.size(); batchStart += batchSize) {
+            const size_t batchEnd{ std::min(frames.size(), batchStart + batchSize) };
+            std::atomic<size_t> next{ batchStart };
+            std::vector<std::thread> workers{};
+
+            for (int t = 0; t < settings.threads; t++) {
+                workers.emplace_back([&] {
+                    SoftwareRenderer renderer{ settings.width, settings.height, settings.supersampling };
+
+                    for (size_t frame = next++; frame < batchEnd; frame = next++) {
+                        std::vector<std::uint8_t>& image{ images[frame - batchStart] };
+
+                        renderer.clear();
+                        camera.draw(renderer, frames[frame]);
+                        renderer.resolve(image);
+
+                        if (!settings.raw) {
+                            std::string name{ std::to_string(frame) };
+                            name = "frame" + std::string(5 - std::min<size_t>(5, name.size()), '0') + name + ".ppm";
+
+                            std::ofstream file{ directory / name, std::ios::binary };
+                            SoftwareRenderer::writePPM(file, image, settings.width, settings.height);
+                        }
+                    }
+                    });
+            }
+
+            for (auto& worker : workers) worker.join();
+
+            if (settings.raw) {
+                for (size_t frame = batchStart; frame < batchEnd; frame++) {
+                    const auto& image{ images[frame - batchStart] };
+                    std::cout.write(reinterpret_cast<const char*>(image.data()), static_cast<std::streamsize>(image.size()));
+                }
+            }
+        }
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    ExportSettings settings{};
+
+    for (int i = 1; i < argc; i++) {
+        const std::string option{ argv[i] };
+        const bool hasValue{ i + 1 < argc };
+
+        if (option == "--raw") settings.raw = true;
+        else if (option == "--clips" && hasValue) settings.clips = std::max(1, std::stoi(argv[++i]));
+        else if (option == "--seed" && hasValue) settings.seed = static_cast<unsigned>(std::stoul(argv[++i]));
+        else if (option == "--scramble-length" && hasValue) settings.scrambleLength = std::max(1, std::stoi(argv[++i]));
+        else if (option == "--width" && hasValue) settings.width = std::max(16, std::stoi(argv[++i]));
+        else if (option == "--height" && hasValue) settings.height = std::max(16, std::stoi(argv[++i]));
+        else if (option == "--fps" && hasValue) settings.fps = std::max(1, std::stoi(argv[++i]));
+        else if (option == "--speed" && hasValue) settings.rotationSpeed = std::max(1.f, std::stof(argv[++i]));
+        else if (option == "--supersampling" && hasValue) settings.supersampling = std::clamp(std::stoi(argv[++i]), 1, 4);
+        else if (option == "--threads" && hasValue) settings.threads = std::max(1, std::stoi(argv[++i]));
+        else if (option == "--tables" && hasValue) settings.tables = argv[++i];
+        else if (option == "--out" && hasValue) settings.output = argv[++i];
+        else {
+            std::cerr << "Usage: cubeexport [--clips N] [--seed S] [--scramble-length MOVES] [--width W] [--height H] [--fps FPS]\n"
+                "                  [--speed DEGREES_PER_SECOND] [--supersampling 1-4] [--threads N] [--tables DIR] [--out DIR | --raw]\n";
+            return 1;
+        }
+    }
+
+    if (settings.raw) std::ios::sync_with_stdio(false);
+
+    const Solver::Tables tables{ Solver::loadTables(settings.tables) };
+
+    for (int clip = 0; clip < settings.clips; clip++) {
+        std::mt19937 rng{ settings.seed + static_cast<unsigned>(clip) };
+        const std::vector<char> scramble{ randomScramble(rng, settings.scrambleLength) };
+
+        Cube scrambled{ cubeletSize };
+        for (char move : scramble) scrambled.turn(move);
+
+        const Solver::SolveResult result{ Solver::solveWithOptions(scrambled, {}, tables) };
+
+        if (!result.moves) {
+            std::cerr << "Clip " << clip << ": no solution found, skipped\n";
+            continue;
+        }
+
+        const std::vector<Cube> frames{ playClip(scramble, Solver::toQuarterTurns(*result.moves), settings) };
+
+        exportClip(clip, frames, settings);
+        std::cerr << "Clip " << clip << ": " << scramble.size() << " scramble turns, " << result.moves->size() << " solution moves, " << frames.size() << " frames\n";
+    }
+}
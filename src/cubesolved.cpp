@@ -0,0 +1,399 @@
+// Solve daemon: keeps the solver tables resident and answers requests on a Unix domain socket.
+//
+// Protocol, one request per line:
+//   <54 facelets>   -> "OK <moves>" or "ERR <reason>"; with --deadline-ms a request gives up after that long,
+//                      with --target-length it keeps shortening the solution until it has that many moves or fewer
+//                      and answers with the best found by the deadline
+//   STATS           -> "OK requests=.. errors=.. queued=.. active=.. mean_us=.. max_us=.. p50_us=.. p99_us=.."
+// Facelets are given face by face in FRBLUD order, row by row, each as the letter of the face whose colour it has.
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <csignal>
+#include <cstring>
+#include <deque>
+#include <filesystem>
+#include <future>
+#include <memory>
+#include <iostream>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "Cube.hpp"
+#include "FaceletCube.hpp"
+#include "Solver.hpp"
+#include "SharedTables.hpp"
+#include "OrientationSearch.hpp"
+#include "TranspositionTable.hpp"
+
+namespace {
+    std::atomic<bool> running{ true };
+
+    void stopRunning(int) {
+        running = false;
+    }
+
+    // open client sockets, so shutdown can unblock their threads and wait for them before tearing down the pool
+    class Connections {
+        std::vector<int> m_open{};
+        std::mutex m_mutex{};
+        std::condition_variable m_closed{};
+
+    public:
+        void add(int fd) {
+            std::lock_guard lock{ m_mutex };
+            m_open.push_back(fd);
+        }
+
+        void remove(int fd) {
+            std::lock_guard lock{ m_mutex };
+            m_open.erase(std::find(m_open.begin(), m_open.end(), fd));
+            m_closed.notify_all();
+        }
+
+        void closeAll() {
+            std::unique_lock lock{ m_mutex };
+            for (int fd : m_open) shutdown(fd, SHUT_RDWR);
+            m_closed.wait(lock, [this] { return m_open.empty(); });
+        }
+    };
+
+    // request latency from being read off the socket to the reply, bucketed by powers of two microseconds
+    class Stats {
+        std::atomic<long long> m_requests{ 0 };
+        std::atomic<long long> m_errors{ 0 };
+        std::atomic<long long> m_totalMicroseconds{ 0 };
+        std::atomic<long long> m_maxMicroseconds{ 0 };
+        std::array<std::atomic<long long>, 40> m_buckets{};
+
+        long long percentile(double fraction) const {
+            const long long target{ static_cast<long long>(fraction * m_requests) };
+            long long seen{ 0 };
+
+            for (size_t i = 0; i < m_buckets.size(); i++) {
+                seen += m_buckets[i];
+                if (seen > target) return 1LL << i;
+            }
+
+            return m_maxMicroseconds;
+        }
+
+    public:
+        void record(long long microseconds, bool error) {
+            m_requests++;
+            if (error) m_errors++;
+            m_totalMicroseconds += microseconds;
+
+            long long max{ m_maxMicroseconds };
+            while (microseconds > max && !m_maxMicroseconds.compare_exchange_weak(max, microseconds)) {}
+
+            int bucket{ 0 };
+            while ((1LL << bucket) < microseconds && bucket + 1 < static_cast<int>(m_buckets.size())) bucket++;
+            m_buckets[bucket]++;
+        }
+
+        std::string format(size_t queued, int active) const {
+            const long long requests{ m_requests };
+
+            return "requests=" + std::to_string(requests) +
+                " errors=" + std::to_string(m_errors) +
+                " queued=" + std::to_string(queued) +
+                " active=" + std::to_string(active) +
+                " mean_us=" + std::to_string(requests ? m_totalMicroseconds / requests : 0) +
+                " max_us=" + std::to_string(m_maxMicroseconds) +
+                " p50_us=" + std::to_string(requests ? percentile(0.5) : 0) +
+                " p99_us=" + std::to_string(requests ? percentile(0.99) : 0);
+        }
+    };
+
+    struct SolveSettings {
+        std::optional<Solver::SearchMode> orientations{};
+        std::optional<std::chrono::milliseconds> deadline{}; // per request, counted from when a worker picks it up
+        std::optional<int> targetLength{};
+        int phase2Threads{ 0 }; // per request, with a target length
+        std::shared_ptr<TranspositionTable> transpositions{}; // shared by all workers
+    };
+
+    struct Job {
+        std::string facelets;
+        std::promise<std::string> reply;
+    };
+
+    // fixed set of solver threads fed by connection threads; the queue length is the backlog of unsolved requests
+    class WorkerPool {
+        const Solver::Tables& m_tables;
+        SolveSettings m_settings;
+        std::vector<std::thread> m_workers{};
+        std::deque<Job> m_queue{};
+        std::mutex m_mutex{};
+        std::condition_variable m_condition{};
+        std::atomic<int> m_active{ 0 };
+        bool m_stopping{ false };
+
+        std::string solve(const std::string& facelets) {
+            if (facelets.size() != FaceletCube::numFacelets) {
+                return "ERR expected " + std::to_string(FaceletCube::numFacelets) + " facelets";
+            }
+
+            const FaceletCube state{ FaceletCube::fromString(facelets) };
+
+            if (const Solver::Validity validity{ Solver::validate(state) }; validity != Solver::VALID) {
+                return "ERR " + std::string{ Solver::describeValidity(validity) };
+            }
+
+            Cube cube{ 0.f };
+            cube.faceColors = state.toFaceColors();
+
+            Solver::SolveOptions options{};
+            if (m_settings.deadline) options.deadline = Solver::SolveClock::now() + *m_settings.deadline;
+            options.targetLength = m_settings.targetLength;
+            options.phase2Threads = m_settings.phase2Threads;
+            options.transpositions = m_settings.transpositions.get();
+
+            const Solver::SolveResult result{ m_settings.orientations ?
+                Solver::solveAllOrientationsWithOptions(cube, *m_settings.orientations, options, m_tables) :
+                Solver::solveWithOptions(cube, options, m_tables) };
+            if (!result.moves) return result.status == Solver::NOT_FOUND ? "ERR no solution found" : "ERR timed out";
+
+            return "OK " + Solver::formatMoves(Solver::toQuarterTurns(*result.moves));
+        }
+
+        void work() {
+            while (true) {
+                Job job{};
+
+                {
+                    std::unique_lock lock{ m_mutex };
+                    m_condition.wait(lock, [this] { return m_stopping || !m_queue.empty(); });
+                    if (m_queue.empty()) return;
+
+                    job = std::move(m_queue.front());
+                    m_queue.pop_front();
+                }
+
+                m_active++;
+                std::string reply{ solve(job.facelets) };
+                m_active--;
+
+                job.reply.set_value(std::move(reply));
+            }
+        }
+
+    public:
+        WorkerPool(const Solver::Tables& tables, int workers, const SolveSettings& settings) :
+            m_tables(tables), m_settings(settings) {
+            for (int i = 0; i < workers; i++) {
+                m_workers.emplace_back([this] { work(); });
+            }
+        }
+
+        ~WorkerPool() {
+            {
+                std::lock_guard lock{ m_mutex };
+                m_stopping = true;
+            }
+
+            m_condition.notify_all();
+            for (auto& worker : m_workers) worker.join();
+        }
+
+        std::future<std::string> submit(std::string facelets) {
+            Job job{ std::move(facelets), {} };
+            auto reply{ job.reply.get_future() };
+
+            {
+                std::lock_guard lock{ m_mutex };
+                m_queue.push_back(std::move(job));
+            }
+
+            m_condition.notify_one();
+            return reply;
+        }
+
+        size_t queued() {
+            std::lock_guard lock{ m_mutex };
+            return m_queue.size();
+        }
+
+        int active() const {
+            return m_active;
+        }
+    };
+
+    bool writeAll(int fd, const std::string& text) {
+        size_t written{ 0 };
+
+        while (written < text.size()) {
+            const ssize_t n{ write(fd, text.data() + written, text.size() - written) };
+            if (n <= 0) return false;
+            written += n;
+        }
+
+        return true;
+    }
+
+    constexpr size_t maxLineLength{ 4096 };
+
+    // requests on one connection are answered in order, different connections are solved concurrently
+    void serveConnection(int fd, WorkerPool& pool, Stats& stats, Connections& connections) {
+        std::string buffer{};
+        std::array<char, 4096> chunk{};
+
+        while (running) {
+            const size_t newline{ buffer.find('\n') };
+
+            if (newline == std::string::npos) {
+                if (buffer.size() > maxLineLength) { // a request is 54 facelets; don't let a client fill memory
+                    writeAll(fd, "ERR line too long\n");
+                    break;
+                }
+
+                const ssize_t n{ read(fd, chunk.data(), chunk.size()) };
+                if (n <= 0) break;
+
+                buffer.append(chunk.data(), n);
+                continue;
+            }
+
+            std::string line{ buffer.substr(0, newline) };
+            buffer.erase(0, newline + 1);
+            if (!line.empty() && line.back() == '\r') line.pop_back();
+
+            std::string reply{};
+
+            if (line == "STATS") {
+                reply = "OK " + stats.format(pool.queued(), pool.active());
+            }
+            else {
+                const auto start{ std::chrono::steady_clock::now() };
+                reply = pool.submit(std::move(line)).get();
+                const auto elapsed{ std::chrono::steady_clock::now() - start };
+
+                stats.record(std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count(), reply.rfind("ERR", 0) == 0);
+            }
+
+            if (!writeAll(fd, reply + '\n')) break;
+        }
+
+        connections.remove(fd);
+        close(fd);
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    std::string socketPath{ "/tmp/cubesolved.sock" };
+    std::string tablesDirectory{ "." };
+    std::string sharedTables{};
+    SolveSettings settings{};
+    std::optional<Solver::TableTier> memoryTier{};
+    const int cores{ static_cast<int>(std::max(1u, std::thread::hardware_concurrency())) };
+    std::optional<int> workers{};
+
+    const auto usage{ [] {
+        std::cerr << "Usage: cubesolved [--socket PATH] [--tables DIR] [--shared NAME] [--orientations first|shortest] [--deadline-ms MS] [--target-length MOVES] [--phase2-threads N] [--transposition-mb MB] [--memory-mb MB] [--workers N]\n";
+        return 1;
+        } };
+
+    for (int i = 1; i < argc; i++) {
+        const std::string option{ argv[i] };
+        if (i + 1 == argc) return usage(); // every option takes a value
+
+        const std::string value{ argv[++i] };
+
+        try {
+            if (option == "--socket") socketPath = value;
+            else if (option == "--tables") tablesDirectory = value;
+            else if (option == "--shared") sharedTables = value;
+            else if (option == "--orientations" && value == "first") settings.orientations = Solver::FIRST;
+            else if (option == "--orientations" && value == "shortest") settings.orientations = Solver::SHORTEST;
+            else if (option == "--deadline-ms") settings.deadline = std::chrono::milliseconds{ std::max(1, std::stoi(value)) };
+            else if (option == "--target-length") settings.targetLength = std::max(0, std::stoi(value));
+            else if (option == "--phase2-threads") settings.phase2Threads = std::max(0, std::stoi(value));
+            else if (option == "--transposition-mb") settings.transpositions = std::make_shared<TranspositionTable>(std::max(1, std::stoi(value)) * size_t{ 1 } << 17);
+            else if (option == "--memory-mb") memoryTier = Solver::chooseTableTier(static_cast<size_t>(std::max(0, std::stoi(value))) << 20);
+            else if (option == "--workers") workers = std::max(1, std::stoi(value));
+            else return usage();
+        }
+        catch (const std::logic_error&) { // std::stoi: not a number, or out of range
+            return usage();
+        }
+    }
+
+    if (!sharedTables.empty() && memoryTier) {
+        std::cerr << "--memory-mb cannot be combined with --shared, the shared segment holds the standard tables\n";
+        return 1;
+    }
+
+    const Solver::TableTier tier{ memoryTier.value_or(Solver::STANDARD) };
+    if (!workers) workers = settings.orientations ? std::max(1, cores / 6) : cores; // an orientations request runs six searches at once
+
+    // zeroed tables would answer every request with a wrong solution
+    if (const std::vector<std::string> missing{ Solver::missingTables(tablesDirectory, tier) }; !missing.empty()) {
+        for (const std::string& filename : missing) {
+            std::cerr << "Table " << (std::filesystem::path{ tablesDirectory } / filename).string() << " is missing or has the wrong size\n";
+        }
+
+        return 1;
+    }
+
+    const Solver::Tables tables{ sharedTables.empty() ? Solver::loadTables(tablesDirectory, tier) : Solver::loadSharedTables(sharedTables, tablesDirectory) };
+    if (tables.tier != tier && sharedTables.empty()) std::cout << "No pruningTable1Exact.bin in " << tablesDirectory << ", using the large tables\n";
+    std::cout << "Tables loaded from " << (sharedTables.empty() ? tablesDirectory : "shared memory " + sharedTables) << ", tier " << Solver::describeTableTier(tables.tier) << '\n';
+
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (socketPath.size() >= sizeof(address.sun_path)) {
+        std::cerr << "Socket path too long: " << socketPath << '\n';
+        return 1;
+    }
+    std::strncpy(address.sun_path, socketPath.c_str(), sizeof(address.sun_path) - 1);
+
+    const int listener{ socket(AF_UNIX, SOCK_STREAM, 0) };
+    unlink(socketPath.c_str());
+
+    if (listener < 0 || bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 || listen(listener, 64) != 0) {
+        std::cerr << "Cannot listen on " << socketPath << ": " << std::strerror(errno) << '\n';
+        return 1;
+    }
+
+    std::signal(SIGINT, stopRunning);
+    std::signal(SIGTERM, stopRunning);
+    std::signal(SIGPIPE, SIG_IGN);
+
+    std::cout << "Listening on " << socketPath << " with " << *workers << " workers\n";
+
+    {
+        WorkerPool pool{ tables, *workers, settings };
+        Stats stats{};
+        Connections connections{};
+
+        while (running) {
+            pollfd pending{ listener, POLLIN, 0 };
+            if (poll(&pending, 1, 200) <= 0) continue; // wake up regularly to notice a stop signal
+
+            const int connection{ accept(listener, nullptr, nullptr) };
+            if (connection < 0) continue;
+
+            connections.add(connection);
+            std::thread{ serveConnection, connection, std::ref(pool), std::ref(stats), std::ref(connections) }.detach();
+        }
+
+        connections.closeAll();
+    }
+
+    close(listener);
+    unlink(socketPath.c_str());
+}
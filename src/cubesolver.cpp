@@ -0,0 +1,263 @@
+// Implementation of the C interface in cubesolver.h on top of the header-only solver.
+
+#include "cubesolver.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <string_view>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include "Cube.hpp"
+#include "FaceletCube.hpp"
+#include "Solver.hpp"
+
+namespace {
+    // one call of cube_solver_solve_batch; lives on the caller's stack and is linked into the context while helpers
+    // may pick up its cubes
+    struct Batch {
+        const char* facelets;
+        size_t count;
+        const cube_solver_limits* limits;
+        char* moves;
+        size_t stride;
+        cube_solver_status* statuses;
+
+        std::atomic<size_t> next{ 0 };
+        int helpers{ 0 }; // helpers working on it, guarded by the context's mutex
+        bool linked{ false };
+        Batch* nextBatch{ nullptr };
+    };
+
+    // face turns in standard notation, merging turns of the same face as formatMoves does; writes what fits into
+    // moves and returns the full length
+    size_t writeMoves(const std::vector<int>& turns, char* moves, size_t capacity) {
+        size_t length{ 0 };
+        const auto put{ [&](char c) {
+            if (length < capacity) moves[length] = c;
+            length++;
+            } };
+
+        for (size_t i = 0; i < turns.size();) {
+            const int face{ turns[i] / 3 };
+            int quarters{ 0 };
+
+            for (; i < turns.size() && turns[i] / 3 == face; i++) {
+                quarters += turns[i] % 3 + 1;
+            }
+
+            if (quarters % 4 == 0) continue;
+
+            if (length > 0) put(' ');
+            put("FRBLUD"[face]);
+            if (quarters % 4 == 2) put('2');
+            if (quarters % 4 == 3) put('\'');
+        }
+
+        if (length < capacity) moves[length] = '\0';
+        return length;
+    }
+
+    cube_solver_status solveOne(const Solver::Tables& tables, const char* facelets, const cube_solver_limits* limits,
+        char* moves, size_t capacity, size_t* length) noexcept {
+        if (length) *length = 0;
+        if (!facelets || (!moves && capacity > 0)) return CUBE_SOLVER_INVALID_ARGUMENT;
+        if (std::find(facelets, facelets + FaceletCube::numFacelets, '\0') != facelets + FaceletCube::numFacelets) return CUBE_SOLVER_INVALID_ARGUMENT; // reads no further than a zero
+
+        try {
+            const FaceletCube state{ FaceletCube::fromString({ facelets, FaceletCube::numFacelets }) };
+            if (Solver::validate(state) != Solver::VALID) return CUBE_SOLVER_INVALID_CUBE;
+
+            Cube cube{ 0.f };
+            cube.faceColors = state.toFaceColors();
+
+            Solver::SolveOptions options{};
+            if (limits && limits->timeout_ms > 0) options.deadline = Solver::SolveClock::now() + std::chrono::milliseconds{ limits->timeout_ms };
+            if (limits && limits->target_length > 0) options.targetLength = limits->target_length;
+
+            const Solver::SolveResult result{ Solver::solveWithOptions(cube, options, tables) };
+            if (!result.moves) return result.status == Solver::TIMED_OUT ? CUBE_SOLVER_TIMED_OUT : CUBE_SOLVER_INTERNAL_ERROR;
+
+            const size_t written{ writeMoves(*result.moves, moves, capacity) };
+            if (length) *length = written;
+
+            return written < capacity ? CUBE_SOLVER_OK : CUBE_SOLVER_BUFFER_TOO_SMALL;
+        }
+        catch (const std::bad_alloc&) {
+            return CUBE_SOLVER_OUT_OF_MEMORY;
+        }
+        catch (...) {
+            return CUBE_SOLVER_INTERNAL_ERROR;
+        }
+    }
+}
+
+struct cube_solver {
+    Solver::Tables tables{};
+    std::vector<std::thread> helpers{};
+
+    std::mutex mutex{};
+    std::condition_variable work{};
+    std::condition_variable finished{};
+    Batch* batches{ nullptr }; // batches that may still have cubes left, newest first
+    bool stopping{ false };
+
+    // solves cubes of the batch until none are left
+    void solveCubes(Batch& batch) {
+        for (size_t i = batch.next++; i < batch.count; i = batch.next++) {
+            batch.statuses[i] = solveOne(tables, batch.facelets + i * CUBE_SOLVER_FACELETS, batch.limits,
+                batch.moves + i * batch.stride, batch.stride, nullptr);
+        }
+    }
+
+    // with the mutex held
+    void unlink(Batch& batch) {
+        if (!batch.linked) return;
+
+        Batch** link{ &batches };
+        while (*link != &batch) link = &(*link)->nextBatch;
+
+        *link = batch.nextBatch;
+        batch.linked = false;
+    }
+
+    void help() {
+        std::unique_lock lock{ mutex };
+
+        while (true) {
+            work.wait(lock, [this] { return stopping || batches; });
+            if (stopping) return;
+
+            Batch& batch{ *batches };
+            if (batch.next >= batch.count) {
+                unlink(batch);
+                continue;
+            }
+
+            batch.helpers++;
+            lock.unlock();
+
+            solveCubes(batch);
+
+            lock.lock();
+            unlink(batch);
+            if (--batch.helpers == 0) finished.notify_all();
+        }
+    }
+
+    cube_solver_status solveBatch(const char* facelets, size_t count, const cube_solver_limits* limits, char* moves, size_t stride, cube_solver_status* statuses) {
+        Batch batch{ facelets, count, limits, moves, stride, statuses };
+
+        if (!helpers.empty() && count > 1) {
+            {
+                std::lock_guard lock{ mutex };
+                batch.nextBatch = batches;
+                batches = &batch;
+                batch.linked = true;
+            }
+
+            work.notify_all();
+        }
+
+        solveCubes(batch);
+
+        {
+            std::unique_lock lock{ mutex };
+            unlink(batch);
+            finished.wait(lock, [&] { return batch.helpers == 0; });
+        }
+
+        for (size_t i = 0; i < count; i++) {
+            if (statuses[i] != CUBE_SOLVER_OK) return statuses[i];
+        }
+
+        return CUBE_SOLVER_OK;
+    }
+
+    ~cube_solver() {
+        {
+            std::lock_guard lock{ mutex };
+            stopping = true;
+        }
+
+        work.notify_all();
+        for (auto& helper : helpers) helper.join();
+    }
+};
+
+extern "C" {
+    int cube_solver_version(void) {
+        return CUBE_SOLVER_VERSION;
+    }
+
+    const char* cube_solver_status_string(cube_solver_status status) {
+        switch (status) {
+        case CUBE_SOLVER_OK: return "ok";
+        case CUBE_SOLVER_INVALID_ARGUMENT: return "invalid argument";
+        case CUBE_SOLVER_TABLES_UNAVAILABLE: return "tables unavailable";
+        case CUBE_SOLVER_INVALID_CUBE: return "invalid cube";
+        case CUBE_SOLVER_BUFFER_TOO_SMALL: return "buffer too small";
+        case CUBE_SOLVER_TIMED_OUT: return "timed out";
+        case CUBE_SOLVER_OUT_OF_MEMORY: return "out of memory";
+        case CUBE_SOLVER_INTERNAL_ERROR: return "internal error";
+        }
+
+        return "unknown status";
+    }
+
+    cube_solver* cube_solver_create(const char* table_directory, int threads, size_t memory_mb, cube_solver_status* status) {
+        const auto fail{ [&](cube_solver_status reason) -> cube_solver* {
+            if (status) *status = reason;
+            return nullptr;
+            } };
+
+        try {
+            const std::filesystem::path directory{ table_directory ? table_directory : "." };
+            const Solver::TableTier tier{ memory_mb > 0 ? Solver::chooseTableTier(memory_mb << 20) : Solver::STANDARD };
+            if (!Solver::missingTables(directory, tier).empty()) return fail(CUBE_SOLVER_TABLES_UNAVAILABLE); // instead of solving with zeroed tables
+
+            auto solver{ std::make_unique<cube_solver>() };
+            solver->tables = Solver::loadTables(directory, tier);
+
+            if (threads <= 0) threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+            for (int i = 1; i < threads; i++) {
+                solver->helpers.emplace_back([s = solver.get()] { s->help(); });
+            }
+
+            if (status) *status = CUBE_SOLVER_OK;
+            return solver.release();
+        }
+        catch (const std::bad_alloc&) {
+            return fail(CUBE_SOLVER_OUT_OF_MEMORY);
+        }
+        catch (const std::system_error&) {
+            return fail(CUBE_SOLVER_OUT_OF_MEMORY); // no more threads
+        }
+        catch (...) {
+            return fail(CUBE_SOLVER_INTERNAL_ERROR);
+        }
+    }
+
+    void cube_solver_free(cube_solver* solver) {
+        delete solver;
+    }
+
+    cube_solver_status cube_solver_solve(cube_solver* solver, const char* facelets, const cube_solver_limits* limits,
+        char* moves, size_t capacity, size_t* length) {
+        if (!solver) return CUBE_SOLVER_INVALID_ARGUMENT;
+        return solveOne(solver->tables, facelets, limits, moves, capacity, length);
+    }
+
+    cube_solver_status cube_solver_solve_batch(cube_solver* solver, const char* facelets, size_t count,
+        const cube_solver_limits* limits, char* moves, size_t stride, cube_solver_status* statuses) {
+        if (!solver || (count > 0 && (!facelets || !moves || stride == 0 || !statuses))) return CUBE_SOLVER_INVALID_ARGUMENT;
+        return solver->solveBatch(facelets, count, limits, moves, stride, statuses);
+    }
+}
@@ -0,0 +1,85 @@
+/* C interface to the two-phase solver, built as the cubesolver shared library for embedding in other programs.
+ *
+ * A context holds the solver tables and a pool of threads for batch solves. It is created once and may then be used
+ * by any number of threads at the same time; every call is independent of the others. Nothing is printed, solutions
+ * are written into buffers owned by the caller. Every solve allocates a little memory for its search paths and its
+ * result on the heap; the context keeps no scratch buffers between calls.
+ *
+ * Facelets are given as 54 characters, face by face in FRBLUD order and row by row, each the letter of the face whose
+ * colour it has (the same format as the cubesolved daemon). Exactly 54 bytes are read per cube and no terminating
+ * zero is needed; a zero among them, e.g. at the end of a shorter string, is an invalid argument and nothing after it
+ * is read. Solutions are written in standard notation, e.g.
+ * "R U2 F'", followed by a terminating zero; CUBE_SOLVER_MOVES_CAPACITY bytes always suffice. */
+
+#ifndef CUBESOLVER_H
+#define CUBESOLVER_H
+
+#include <stddef.h>
+
+#if defined(_WIN32)
+#  if defined(CUBE_SOLVER_BUILD)
+#    define CUBE_SOLVER_API __declspec(dllexport)
+#  else
+#    define CUBE_SOLVER_API __declspec(dllimport)
+#  endif
+#else
+#  define CUBE_SOLVER_API __attribute__((visibility("default")))
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CUBE_SOLVER_VERSION 2
+#define CUBE_SOLVER_FACELETS 54
+#define CUBE_SOLVER_MOVES_CAPACITY 128
+
+typedef struct cube_solver cube_solver;
+
+typedef enum cube_solver_status {
+    CUBE_SOLVER_OK = 0,
+    CUBE_SOLVER_INVALID_ARGUMENT = 1,
+    CUBE_SOLVER_TABLES_UNAVAILABLE = 2, /* a table file is missing or has the wrong size */
+    CUBE_SOLVER_INVALID_CUBE = 3,       /* unknown letters, or a state no sequence of turns can reach */
+    CUBE_SOLVER_BUFFER_TOO_SMALL = 4,
+    CUBE_SOLVER_TIMED_OUT = 5,          /* no solution found within the time limit */
+    CUBE_SOLVER_OUT_OF_MEMORY = 6,
+    CUBE_SOLVER_INTERNAL_ERROR = 7      /* anything else that went wrong inside the library */
+} cube_solver_status;
+
+/* optional limits on one solve; zero means no limit */
+typedef struct cube_solver_limits {
+    int timeout_ms;    /* give up after this long, returning the shortest solution found so far if any */
+    int target_length; /* keep shortening the solution until it has this many moves or fewer */
+} cube_solver_limits;
+
+/* the value of CUBE_SOLVER_VERSION the library was built with */
+CUBE_SOLVER_API int cube_solver_version(void);
+
+CUBE_SOLVER_API const char* cube_solver_status_string(cube_solver_status status);
+
+/* loads the tables generated by the main program from table_directory (the working directory if null) and starts
+ * threads - 1 helper threads for batch solves (one per hardware thread if threads <= 0); null on failure, with the
+ * reason in *status if status is not null. memory_mb picks the largest table tier that fits in that many megabytes,
+ * like cubesolved --memory-mb; 0 loads the standard tables */
+CUBE_SOLVER_API cube_solver* cube_solver_create(const char* table_directory, int threads, size_t memory_mb, cube_solver_status* status);
+
+/* stops the helper threads and releases the tables; no other call on the context may still be running */
+CUBE_SOLVER_API void cube_solver_free(cube_solver* solver);
+
+/* solves one cube into moves, which has room for capacity bytes; the solution length in characters (without the
+ * terminating zero) is stored in *length if length is not null, also when the buffer is too small; limits may be null */
+CUBE_SOLVER_API cube_solver_status cube_solver_solve(cube_solver* solver, const char* facelets, const cube_solver_limits* limits,
+    char* moves, size_t capacity, size_t* length);
+
+/* solves count cubes, stored one after another in facelets, on the calling thread and the context's helpers; the
+ * solution of cube i goes to moves + i * stride and its status to statuses[i]. Returns CUBE_SOLVER_OK if every cube
+ * was solved, otherwise the status of the first one that was not */
+CUBE_SOLVER_API cube_solver_status cube_solver_solve_batch(cube_solver* solver, const char* facelets, size_t count,
+    const cube_solver_limits* limits, char* moves, size_t stride, cube_solver_status* statuses);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
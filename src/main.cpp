@@ -1,10 +1,27 @@
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdlib>
 #include <iostream>
+#include <memory>
+#include <optional>
+#include <random>
+#include <string>
+#include <type_traits>
+#include <vector>
 
 #include <SFML/Graphics.hpp>
 
 #include "Camera.hpp"
 #include "Cube.hpp"
 #include "Solver.hpp"
+#include "Scrambler.hpp"
+#include "OrientationSearch.hpp"
+#include "GridViewer.hpp"
+#include "PerformanceHud.hpp"
+#include "StreamingSolve.hpp"
+#include "InputTrace.hpp"
+#include "SoftwareRenderer.hpp"
 
 constexpr int windowWidth{ 800 };
 constexpr int windowHeight{ 600 };
@@ -12,72 +29,340 @@ constexpr int windowHeight{ 600 };
 constexpr float rotationSpeed{ .1f };
 constexpr float faceRotationSpeed{ 500.f };
 constexpr float cubeletSize{ 2.f };
+constexpr unsigned maxFramerate{ 60 }; // while animating; an idle cube is not redrawn at all
 
-int main()
+// keys that turn the cube, and so have to wait while a solve is being queued
+bool turnsCube(sf::Keyboard::Scancode key) {
+    using sf::Keyboard::Scancode;
+    return key != Scancode::Up && key != Scancode::Down && key != Scancode::Left && key != Scancode::Right &&
+        key != Scancode::T && key != Scancode::H;
+}
+
+// what a key does to the cube: view rotations, turbo, layers, face turns and shuffles, the same in the window and in
+// --replay; H and Enter are left to the caller
+template <int N>
+void applyKey(BasicCube<N>& cube, sf::Keyboard::Scancode key, bool shift, int& layer, Scrambler::Generator& scrambler) {
+    const int numberKey{ static_cast<int>(key) - static_cast<int>(sf::Keyboard::Scancode::Num1) };
+
+    if (key == sf::Keyboard::Scancode::Up)
+        cube.rotate(-rotationSpeed, { 1.f, 0.f, 0.f });
+    else if (key == sf::Keyboard::Scancode::Down)
+        cube.rotate(rotationSpeed, { 1.f, 0.f, 0.f });
+    else if (key == sf::Keyboard::Scancode::Left)
+        cube.rotate(-rotationSpeed, { 0.f, 1.f, 0.f });
+    else if (key == sf::Keyboard::Scancode::Right)
+        cube.rotate(rotationSpeed, { 0.f, 1.f, 0.f });
+
+    else if (key == sf::Keyboard::Scancode::T)
+        cube.setTurbo(!cube.isTurbo());
+
+    else if (numberKey >= 0 && numberKey < N)
+        layer = numberKey;
+
+    else if (key == sf::Keyboard::Scancode::U)
+        cube.startRotation('U', std::exchange(layer, 0));
+    else if (key == sf::Keyboard::Scancode::D)
+        cube.startRotation('D', std::exchange(layer, 0));
+    else if (key == sf::Keyboard::Scancode::L)
+        cube.startRotation('L', std::exchange(layer, 0));
+    else if (key == sf::Keyboard::Scancode::R)
+        cube.startRotation('R', std::exchange(layer, 0));
+    else if (key == sf::Keyboard::Scancode::F)
+        cube.startRotation('F', std::exchange(layer, 0));
+    else if (key == sf::Keyboard::Scancode::B)
+        cube.startRotation('B', std::exchange(layer, 0));
+
+    else if (key == sf::Keyboard::Scancode::Space && shift) {
+        if constexpr (N == 3) { // jump straight to a uniformly random state, without animating
+            if (cube.getState() == BasicCube<N>::IDLE) {
+                cube.faceColors = scrambler.nextState().toFaceColors();
+            }
+        }
+    }
+    else if (key == sf::Keyboard::Scancode::Space)
+        cube.shuffle(20);
+}
+
+// with a record path, the handled key presses are written to it as an input trace for --replay
+template <int N>
+void run(const std::string& recordPath)
 {
-    Cube cube{ cubeletSize };
+    BasicCube<N> cube{ cubeletSize * 3.f / static_cast<float>(N) }; // keep the whole cube the same size on screen
     Camera cam{ windowWidth, windowHeight };
 
+    const unsigned seed{ std::random_device{}() };
+    std::optional<InputTrace::Recorder> recorder{};
+
+    if (!recordPath.empty()) {
+        recorder.emplace(recordPath, seed);
+        if (!recorder->isOpen()) {
+            std::cerr << "Cannot write trace " << recordPath << '\n';
+            return;
+        }
+
+        std::srand(seed); // so the replay shuffles the same way
+    }
+
     sf::ContextSettings settings;
     settings.antiAliasingLevel = 8;
     auto window{ sf::RenderWindow(sf::VideoMode({ windowWidth, windowHeight}), "SFML", sf::Style::Default, sf::State::Windowed, settings) };
+    window.setFramerateLimit(maxFramerate);
 
     static sf::Clock clock;
     static float frameTime{ 0.f };
 
-    // Solver::generateAllTables();
+    cube.setTurbo(true);
 
-    while (window.isOpen())
-    {
-        while (const std::optional event{ window.pollEvent() })
+    int layer{ 0 }; // set by the number keys, applies to the next face turn only
+    Scrambler::Generator scrambler{ seed };
+
+    // something visible changed since the last frame; nothing else is drawn, and while the cube is idle the loop
+    // sleeps in waitEvent instead of spinning
+    bool redraw{ true };
+
+    std::unique_ptr<StreamingSolve> solving{}; // the solve started with Enter, until all its moves are queued
+
+    PerformanceHud hud{};
+    bool showHud{ false };
+
+    const auto handleEvent{ [&](const sf::Event& event) {
+        redraw = true;
+
+        if (event.is<sf::Event::Closed>())
+            window.close();
+
+        else if (const auto* keyPressed = event.getIf<sf::Event::KeyPressed>())
         {
-            if (event->is<sf::Event::Closed>())
-                window.close();
-
-            else if (const auto* keyPressed = event->getIf<sf::Event::KeyPressed>())
-            {
-                if (keyPressed->scancode == sf::Keyboard::Scancode::Up)
-                    cube.rotate(-rotationSpeed, { 1.f, 0.f, 0.f });
-                else if (keyPressed->scancode == sf::Keyboard::Scancode::Down)
-                    cube.rotate(rotationSpeed, { 1.f, 0.f, 0.f });
-                else if (keyPressed->scancode == sf::Keyboard::Scancode::Left)
-                    cube.rotate(-rotationSpeed, { 0.f, 1.f, 0.f });
-                else if (keyPressed->scancode == sf::Keyboard::Scancode::Right)
-                    cube.rotate(rotationSpeed, { 0.f, 1.f, 0.f });
-
-                else if (keyPressed->scancode == sf::Keyboard::Scancode::U)
-                    cube.startRotation('U');
-                else if (keyPressed->scancode == sf::Keyboard::Scancode::D)
-                    cube.startRotation('D');
-                else if (keyPressed->scancode == sf::Keyboard::Scancode::L)
-                    cube.startRotation('L');
-                else if (keyPressed->scancode == sf::Keyboard::Scancode::R)
-                    cube.startRotation('R');
-                else if (keyPressed->scancode == sf::Keyboard::Scancode::F)
-                    cube.startRotation('F');
-                else if (keyPressed->scancode == sf::Keyboard::Scancode::B)
-                    cube.startRotation('B');
-
-                else if (keyPressed->scancode == sf::Keyboard::Scancode::Space)
-                    cube.shuffle(20);
-
-                else if (keyPressed->scancode == sf::Keyboard::Scancode::Enter && cube.getState() == Cube::IDLE) {
-                    auto solution{ Solver::solve(cube) };
-                    for (const auto& move : solution) {
-                        cube.startRotation(move);
-                    }
+            if (solving && turnsCube(keyPressed->scancode)) return; // any turn now would come before the rest of the solution
+            if (recorder) recorder->record(keyPressed->scancode, keyPressed->shift);
+
+            if (keyPressed->scancode == sf::Keyboard::Scancode::H)
+                showHud = !showHud;
 
+            else if (keyPressed->scancode == sf::Keyboard::Scancode::Enter) {
+                if (cube.getState() != BasicCube<N>::IDLE) return;
+
+                if constexpr (N == 3) { // the solver only knows the 3x3
+                    if (keyPressed->shift) {
+                        for (const auto& move : Solver::solveAllOrientations(cube, Solver::FIRST)) {
+                            cube.startRotation(move);
+                        }
+                    }
+                    else {
+                        solving = std::make_unique<StreamingSolve>(cube); // phase 1 moves start turning before phase 2 is done
+                    }
                 }
             }
+
+            else applyKey(cube, keyPressed->scancode, keyPressed->shift, layer, scrambler);
         }
+        } };
 
-        window.clear();
+    while (window.isOpen())
+    {
+        if (!redraw && cube.getState() == BasicCube<N>::IDLE) {
+            if (const std::optional event{ window.waitEvent() }) handleEvent(*event);
+            clock.restart(); // time spent waiting is not animation time
+        }
+
+        while (const std::optional event{ window.pollEvent() })
+            handleEvent(*event);
+
+        if (solving) {
+            const bool finished{ solving->isFinished() }; // checked first, so no moves can arrive after the last take
+
+            for (char move : solving->takeMoves()) {
+                cube.startRotation(move);
+            }
+
+            if (finished) {
+                if (const auto stats{ solving->getStats() }) hud.setSolveStats(*stats);
+                solving.reset();
+            }
+            redraw = true; // keeps polling at the frame rate while phase 2 runs
+        }
 
         frameTime = clock.restart().asSeconds();
 
-        cube.manageRotation(faceRotationSpeed * frameTime);
+        if (cube.getState() == BasicCube<N>::ROTATING) {
+            cube.manageRotation(faceRotationSpeed * frameTime);
+            redraw = true; // also draws the frame the last turn finishes in
+        }
+
+        if (!redraw) continue;
+        redraw = false;
+
+        hud.addFrame(frameTime);
+
+        window.clear();
         cam.draw(window, cube);
 
+        if (showHud) {
+            std::optional<size_t> tableBytes{};
+            if constexpr (N == 3) tableBytes = Solver::tableBytes(Solver::getTables().tier, false) + Solver::getTables().endgame2.getBytes(); // loads them if nothing was solved yet
+
+            hud.draw(window, cube.getQueueLength(), tableBytes);
+        }
+
         window.display();
     }
 }
+
+// Replays a trace from --record without a window: key presses are applied at their recorded times and the cube is
+// animated at the window's frame rate, and every frame the window would have drawn is drawn with the software
+// renderer. Prints the wall time per frame spent animating and drawing; solves (Enter) are run before their frame
+// and not counted, and H is ignored.
+template <int N>
+int replay(const std::string& path)
+{
+    const std::optional<InputTrace::Trace> trace{ InputTrace::load(path) };
+    if (!trace) {
+        std::cerr << "Cannot read trace " << path << '\n';
+        return 1;
+    }
+
+    BasicCube<N> cube{ cubeletSize * 3.f / static_cast<float>(N) };
+    Camera cam{ windowWidth, windowHeight };
+    SoftwareRenderer renderer{ windowWidth, windowHeight, 1 }; // no supersampling, so drawing the cube is not lost in rasterising
+
+    cube.setTurbo(true);
+
+    int layer{ 0 };
+    std::srand(trace->seed);
+    Scrambler::Generator scrambler{ trace->seed };
+
+    const float frameTime{ 1.f / maxFramerate };
+    const std::vector<InputTrace::Event>& events{ trace->events };
+    std::vector<double> frameMilliseconds{};
+    size_t next{ 0 };
+    double now{ 0.0 };
+    bool redraw{ true };
+
+    while (redraw || next < events.size() || cube.getState() != BasicCube<N>::IDLE) {
+        if (!redraw && cube.getState() == BasicCube<N>::IDLE && next < events.size()) {
+            now = std::max(now, events[next].seconds); // the window sleeps until the next key
+        }
+
+        for (; next < events.size() && events[next].seconds <= now; next++) {
+            const InputTrace::Event& event{ events[next] };
+            redraw = true;
+
+            if (event.key == sf::Keyboard::Scancode::Enter) {
+                if constexpr (N == 3) {
+                    if (cube.getState() != BasicCube<N>::IDLE) continue;
+
+                    const Solver::Tables& tables{ Solver::getTables() };
+                    const Solver::SolveResult result{ event.shift ? Solver::solveAllOrientationsWithOptions(cube, Solver::FIRST, {}, tables) : Solver::solveWithOptions(cube, {}, tables) };
+                    if (!result.moves) continue;
+
+                    for (char move : Solver::toQuarterTurns(*result.moves)) cube.startRotation(move);
+                }
+            }
+            else applyKey(cube, event.key, event.shift, layer, scrambler);
+        }
+
+        const auto frameStart{ std::chrono::steady_clock::now() };
+
+        if (cube.getState() == BasicCube<N>::ROTATING) {
+            cube.manageRotation(faceRotationSpeed * frameTime);
+            redraw = true;
+        }
+
+        if (redraw) {
+            renderer.clear();
+            cam.draw(renderer, cube);
+            frameMilliseconds.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - frameStart).count());
+        }
+
+        redraw = false;
+        now += frameTime;
+    }
+
+    std::vector<double> sorted{ frameMilliseconds };
+    std::sort(sorted.begin(), sorted.end());
+
+    double total{ 0.0 };
+    for (double milliseconds : sorted) total += milliseconds;
+
+    const auto percentile{ [&](double fraction) { return sorted[std::min(sorted.size() - 1, static_cast<size_t>(fraction * sorted.size()))]; } };
+
+    std::cout << events.size() << " key presses over " << now << " s, " << sorted.size() << " frames drawn\n"
+        << "Wall time per frame: mean " << total / sorted.size() << " ms, p50 " << percentile(.5) << " ms, p90 " << percentile(.9)
+        << " ms, p99 " << percentile(.99) << " ms, max " << sorted.back() << " ms\n";
+    return 0;
+}
+
+int main(int argc, char* argv[])
+{
+    // the table files are written to the working directory
+    if (argc == 2 && std::string{ argv[1] } == "--generate-tables") {
+        Solver::generateAllTables();
+        return 0;
+    }
+
+    if (argc == 2 && std::string{ argv[1] } == "--generate-exact-table") { // optional, for the exact table tier
+        Solver::generatePhase1ExactTable();
+        return 0;
+    }
+
+    if (argc > 2 && std::string{ argv[1] } == "--grid") { // e.g. --grid 12x10
+        const std::string grid{ argv[2] };
+        const size_t separator{ grid.find('x') };
+        int columns{ 0 };
+        int rows{ 0 };
+
+        try {
+            columns = std::stoi(grid.substr(0, separator));
+            rows = separator == std::string::npos ? columns : std::stoi(grid.substr(separator + 1));
+        }
+        catch (const std::exception&) {}
+
+        if (columns < 1 || rows < 1 || columns > GridViewer::maxColumns || rows > GridViewer::maxRows) {
+            std::cerr << "Unsupported grid: " << grid << " (expected 1x1 to " << GridViewer::maxColumns << 'x' << GridViewer::maxRows << ")\n";
+            return 1;
+        }
+
+        GridViewer::run(columns, rows);
+        return 0;
+    }
+
+    int size{ 3 };
+    std::string recordPath{};
+    std::string replayPath{};
+
+    for (int i = 1; i < argc; i++) {
+        const std::string option{ argv[i] };
+        const bool hasValue{ i + 1 < argc };
+
+        if (option == "--record" && hasValue) recordPath = argv[++i];
+        else if (option == "--replay" && hasValue) replayPath = argv[++i];
+        else if (!option.empty() && option.size() < 3 && std::all_of(option.begin(), option.end(), [](unsigned char c) { return std::isdigit(c); })) size = std::stoi(option);
+        else {
+            std::cerr << "Usage: main [SIZE] [--record FILE | --replay FILE]\n"
+                "       main --grid COLUMNSxROWS\n"
+                "       main --generate-tables | --generate-exact-table\n";
+            return 1;
+        }
+    }
+
+    // the window, or the headless replay of a trace
+    const auto start{ [&](auto sides) {
+        constexpr int N{ decltype(sides)::value };
+        if (!replayPath.empty()) return replay<N>(replayPath);
+
+        run<N>(recordPath);
+        return 0;
+        } };
+
+    switch (size) {
+    case 2: return start(std::integral_constant<int, 2>{});
+    case 3: return start(std::integral_constant<int, 3>{});
+    case 4: return start(std::integral_constant<int, 4>{});
+    case 5: return start(std::integral_constant<int, 5>{});
+    case 6: return start(std::integral_constant<int, 6>{});
+    case 7: return start(std::integral_constant<int, 7>{});
+    default:
+        std::cerr << "Unsupported cube size: " << size << " (expected " << minSides << " to " << maxSides << ")\n";
+        return 1;
+    }
+}
@@ -0,0 +1,277 @@
+// End-to-end solver benchmark: solves a fixed, seeded corpus and reports latency percentiles, solution lengths and
+// searched nodes, optionally gating on a stored baseline, e.g.
+//   solve-bench --write-baseline bench.txt          # record the current numbers
+//   solve-bench --baseline bench.txt --threshold 15 # exit 1 if nodes or solution lengths got more than 15% worse
+//   solve-bench --baseline bench.txt --latency-threshold 50 # and if a latency figure got more than 50% worse
+//
+// Nodes and lengths are the same on every run with the same corpus and tables, so they are gated by default;
+// latencies depend on the machine and its load, so they are only gated when asked to.
+// The corpus has three groups: uniformly random states, superflip-style states (every edge flipped, pieces mixed
+// by random phase 2 moves, so phase 1 has the most work) and a few classic distance 20 positions.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <optional>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "Cube.hpp"
+#include "FaceletCube.hpp"
+#include "Scrambler.hpp"
+#include "Solver.hpp"
+
+namespace {
+    struct BenchSettings {
+        int random{ 100 };
+        int superflip{ 10 };
+        std::uint64_t seed{ 1 };
+        std::string tables{ "." };
+        Solver::TableTier tier{ Solver::STANDARD };
+        std::string baseline{};
+        std::string writeBaseline{};
+        double threshold{ 20.0 }; // percent
+        std::optional<double> latencyThreshold{}; // percent, latencies are not gated without it
+    };
+
+    struct Position {
+        std::string group;
+        FaceletCube state;
+    };
+
+    struct Sample {
+        double milliseconds;
+        int length;
+        long long nodes;
+    };
+
+    // applies moves in standard notation, e.g. "R U2 F'"
+    void applyNotation(FaceletCube& cube, std::string_view moves) {
+        for (size_t i = 0; i < moves.size(); i++) {
+            const size_t face{ std::string_view{ "FRBLUD" }.find(moves[i]) };
+            if (face == std::string_view::npos) continue;
+
+            int quarterTurns{ 1 };
+            if (i + 1 < moves.size() && moves[i + 1] == '2') quarterTurns = 2;
+            if (i + 1 < moves.size() && moves[i + 1] == '\'') quarterTurns = 3;
+
+            cube.move(static_cast<int>(face) * 3 + quarterTurns - 1);
+        }
+    }
+
+    FaceletCube superflip() {
+        Solver::CubieCube cubies{};
+        cubies.eo.fill(1);
+        return cubies.toFaceletCube();
+    }
+
+    std::vector<Position> buildCorpus(const BenchSettings& settings) {
+        std::vector<Position> corpus{};
+
+        Scrambler::Generator generator{ settings.seed };
+        for (int i = 0; i < settings.random; i++) {
+            corpus.push_back({ "random", generator.nextState() });
+        }
+
+        // phase 2 moves keep every edge flipped
+        std::mt19937_64 rng{ settings.seed };
+        for (int i = 0; i < settings.superflip; i++) {
+            FaceletCube cube{ superflip() };
+
+            for (int j = 0; j < 30; j++) {
+                const int move{ std::uniform_int_distribution<int>{ 0, 9 }(rng) };
+                cube.move(move < 4 ? move * 3 + 1 : 12 + move - 4);
+            }
+
+            corpus.push_back({ "superflip", cube });
+        }
+
+        for (std::string_view moves : { "", "F2 B2 U D' R2 L2 U D'", "U2 D2 F2 B2 L2 R2" }) { // superflip, with four spot, with checkerboard
+            FaceletCube cube{ superflip() };
+            applyNotation(cube, moves);
+            corpus.push_back({ "hard", cube });
+        }
+
+        return corpus;
+    }
+
+    // metric name -> value; for every metric larger is worse
+    using Metrics = std::map<std::string, double>;
+
+    double percentile(std::vector<double> values, double fraction) {
+        std::sort(values.begin(), values.end());
+        return values[std::min(values.size() - 1, static_cast<size_t>(fraction * values.size()))];
+    }
+
+    Metrics summarise(const std::vector<Sample>& samples) {
+        std::vector<double> latencies{};
+        double lengthSum{ 0 };
+        int maxLength{ 0 };
+        long long nodes{ 0 };
+
+        for (const Sample& sample : samples) {
+            latencies.push_back(sample.milliseconds);
+            lengthSum += sample.length;
+            maxLength = std::max(maxLength, sample.length);
+            nodes += sample.nodes;
+        }
+
+        return {
+            { "p50_ms", percentile(latencies, .5) },
+            { "p90_ms", percentile(latencies, .9) },
+            { "p99_ms", percentile(latencies, .99) },
+            { "max_ms", *std::max_element(latencies.begin(), latencies.end()) },
+            { "mean_length", lengthSum / samples.size() },
+            { "max_length", static_cast<double>(maxLength) },
+            { "nodes", static_cast<double>(nodes) }
+        };
+    }
+
+    void print(const std::string& group, size_t count, const Metrics& metrics) {
+        std::cout << std::left << std::setw(10) << group << std::right << std::setw(5) << count << std::fixed;
+
+        for (const auto& [name, value] : metrics) {
+            std::cout << "  " << name << '=' << std::setprecision(name == "nodes" || name == "max_length" ? 0 : 2) << value;
+        }
+
+        std::cout << '\n';
+    }
+
+    // one "name=value" per line, for the whole corpus; empty if the file is missing or corrupt
+    Metrics readBaseline(const std::string& path) {
+        Metrics metrics{};
+        std::ifstream in{ path };
+        std::string line{};
+
+        while (std::getline(in, line)) {
+            const size_t separator{ line.find('=') };
+            if (separator == std::string::npos) continue;
+
+            try {
+                metrics[line.substr(0, separator)] = std::stod(line.substr(separator + 1));
+            }
+            catch (const std::logic_error&) { // not a number, or out of range
+                return {};
+            }
+        }
+
+        return metrics;
+    }
+
+    void writeBaseline(const std::string& path, const Metrics& metrics) {
+        std::ofstream out{ path };
+        out << std::setprecision(10);
+
+        for (const auto& [name, value] : metrics) {
+            out << name << '=' << value << '\n';
+        }
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    BenchSettings settings{};
+
+    const auto usage{ [] {
+        std::cerr << "Usage: solve-bench [--random N] [--superflip N] [--seed S] [--tables DIR] [--memory-mb MB]\n"
+            "                   [--baseline FILE] [--write-baseline FILE] [--threshold PERCENT] [--latency-threshold PERCENT]\n";
+        return 1;
+        } };
+
+    for (int i = 1; i < argc; i++) {
+        const std::string option{ argv[i] };
+        const bool hasValue{ i + 1 < argc };
+
+        try {
+            if (option == "--random" && hasValue) settings.random = std::max(0, std::stoi(argv[++i]));
+            else if (option == "--superflip" && hasValue) settings.superflip = std::max(0, std::stoi(argv[++i]));
+            else if (option == "--seed" && hasValue) settings.seed = std::stoull(argv[++i]);
+            else if (option == "--tables" && hasValue) settings.tables = argv[++i];
+            else if (option == "--memory-mb" && hasValue) settings.tier = Solver::chooseTableTier(static_cast<size_t>(std::max(0, std::stoi(argv[++i]))) << 20);
+            else if (option == "--baseline" && hasValue) settings.baseline = argv[++i];
+            else if (option == "--write-baseline" && hasValue) settings.writeBaseline = argv[++i];
+            else if (option == "--threshold" && hasValue) settings.threshold = std::max(0.0, std::stod(argv[++i]));
+            else if (option == "--latency-threshold" && hasValue) settings.latencyThreshold = std::max(0.0, std::stod(argv[++i]));
+            else return usage();
+        }
+        catch (const std::logic_error&) { // not a number, or out of range
+            return usage();
+        }
+    }
+
+    const Solver::Tables tables{ Solver::loadTables(settings.tables, settings.tier) };
+    const std::vector<Position> corpus{ buildCorpus(settings) };
+    std::cout << "Solving " << corpus.size() << " positions, tables: " << Solver::describeTableTier(tables.tier) << '\n';
+
+    std::map<std::string, std::vector<Sample>> groups{};
+    std::vector<Sample> all{};
+
+    for (const Position& position : corpus) {
+        Cube cube{ 0.f };
+        cube.faceColors = position.state.toFaceColors();
+
+        const auto start{ std::chrono::steady_clock::now() };
+        const Solver::SolveResult result{ Solver::solveWithOptions(cube, {}, tables) };
+        const double milliseconds{ std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() };
+
+        if (!result.moves) {
+            std::cerr << "No solution for a " << position.group << " position: " << position.state.toString() << '\n';
+            return 1;
+        }
+
+        const Sample sample{ milliseconds, static_cast<int>(result.moves->size()), result.stats.phase1Nodes + result.stats.phase2Nodes };
+        groups[position.group].push_back(sample);
+        all.push_back(sample);
+    }
+
+    for (const auto& [group, samples] : groups) print(group, samples.size(), summarise(samples));
+
+    const Metrics total{ summarise(all) };
+    print("all", all.size(), total);
+
+    if (!settings.writeBaseline.empty()) {
+        writeBaseline(settings.writeBaseline, total);
+        std::cout << "Baseline written to " << settings.writeBaseline << '\n';
+    }
+
+    if (settings.baseline.empty()) return 0;
+
+    const Metrics baseline{ readBaseline(settings.baseline) };
+    if (baseline.empty()) {
+        std::cerr << "Cannot read baseline " << settings.baseline << '\n';
+        return 1;
+    }
+
+    bool regressed{ false };
+
+    for (const auto& [name, value] : total) {
+        const auto expected{ baseline.find(name) };
+        if (expected == baseline.end()) continue;
+
+        const bool latency{ name.size() > 3 && name.compare(name.size() - 3, 3, "_ms") == 0 };
+        const std::optional<double> threshold{ latency ? settings.latencyThreshold : settings.threshold };
+        const double change{ expected->second > 0.0 ? (value / expected->second - 1.0) * 100.0 : 0.0 };
+
+        std::cout << std::left << std::setw(12) << name << std::right << std::setprecision(2) << std::setw(14) << expected->second
+            << " -> " << std::setw(14) << value << std::showpos << std::setw(10) << change << '%' << std::noshowpos;
+
+        if (!threshold) {
+            std::cout << "  (not gated)";
+        }
+        else if (value > expected->second * (1.0 + *threshold / 100.0)) {
+            std::cout << "  REGRESSION";
+            regressed = true;
+        }
+
+        std::cout << '\n';
+    }
+
+    return regressed ? 1 : 0;
+}